@@ -0,0 +1,159 @@
+// Microbenchmarks for the hot paths of autowaybar.
+// Build and run inside a Hyprland session:
+//   xmake f -m release && xmake && xmake build autowaybar-bench && xmake run autowaybar-bench
+// xmake puts both binaries in the same directory, which is where the size of
+// autowaybar is read from unless a path is given after the iteration count.
+// The old jsoncpp parse is timed too after xmake f --bench-jsoncpp=y; the
+// numbers measured when JsonPull replaced it are in bench/RESULTS.md.
+#include "Hyprland.hpp"
+#include "jsonpull.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <unistd.h>
+#ifdef BENCH_JSONCPP
+#include <json/json.h>
+#include <sstream>
+#endif
+
+// every heap allocation in the process is counted
+static size_t g_allocations = 0;
+
+auto operator new(std::size_t size) -> void* {
+    ++g_allocations;
+    if (void* ptr = std::malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); }
+auto operator delete(void* ptr, std::size_t) noexcept -> void { std::free(ptr); }
+
+// average wall time of one call in microseconds
+template <typename Fn>
+auto measure(int iterations, Fn&& fn) -> double {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+auto report(std::string_view name, double usec) -> void {
+    fmt::print("{:<28} {:>10.1f} us/op\n", name, usec);
+}
+
+// like measure, plus heap allocations per call
+template <typename Fn>
+auto reportWithAllocations(std::string_view name, int iterations, Fn&& fn) -> void {
+    size_t before = g_allocations;
+    double usec = measure(iterations, fn);
+    fmt::print("{:<28} {:>10.1f} us/op {:>8.1f} allocs/op\n", name, usec,
+               static_cast<double>(g_allocations - before) / iterations);
+}
+
+auto benchCursorPos(int iterations) -> void {
+    char buf[64];
+    if (hyprRequest("cursorpos", buf, sizeof(buf)) <= 0) {
+        log_message(WARN, "Hyprland socket not reachable, skipping cursorpos benchmark\n");
+        return;
+    }
+
+    report("cursorpos (socket)", measure(iterations, [&] {
+        ssize_t bytes = hyprRequest("cursorpos", buf, sizeof(buf));
+        parseCursorPos({buf, static_cast<size_t>(bytes)});
+    }));
+
+    if (access("/usr/bin/hyprctl", X_OK) == 0) {
+        report("cursorpos (hyprctl exec)", measure(iterations, [] {
+            parseCursorPos(execute_command("/usr/bin/hyprctl cursorpos"));
+        }));
+    }
+}
+
+// cost of one posix_spawn + pipe + waitpid round, the price of every external command
+auto benchSpawn(int iterations) -> void {
+    report("spawn /bin/true", measure(iterations, [] {
+        run_command("/bin/true");
+    }));
+}
+
+// j/monitors reply of a two monitor setup, shaped like Hyprland's
+constexpr std::string_view SAMPLE_MONITORS = R"([{
+    "id": 0, "name": "DP-1", "description": "Dell Inc. DELL U2720Q", "make": "Dell Inc.", "model": "DELL U2720Q",
+    "serial": "ABC123", "width": 3840, "height": 2160, "refreshRate": 59.99700, "x": 0, "y": 0,
+    "activeWorkspace": {"id": 1, "name": "1"}, "specialWorkspace": {"id": 0, "name": ""},
+    "reserved": [0, 30, 0, 0], "scale": 1.50, "transform": 0, "focused": true, "dpmsStatus": true,
+    "vrr": false, "solitary": "0", "activelyTearing": false, "disabled": false, "currentFormat": "XRGB8888",
+    "mirrorOf": "none", "availableModes": ["3840x2160@60.00Hz", "2560x1440@59.95Hz", "1920x1080@60.00Hz"]
+},{
+    "id": 1, "name": "HDMI-A-1", "description": "LG Electronics 27GL850", "make": "LG Electronics", "model": "27GL850",
+    "serial": "XYZ789", "width": 2560, "height": 1440, "refreshRate": 143.99800, "x": 2560, "y": 0,
+    "activeWorkspace": {"id": 2, "name": "2"}, "specialWorkspace": {"id": 0, "name": ""},
+    "reserved": [0, 30, 0, 0], "scale": 1.00, "transform": 0, "focused": false, "dpmsStatus": true,
+    "vrr": false, "solitary": "0", "activelyTearing": false, "disabled": false, "currentFormat": "XRGB8888",
+    "mirrorOf": "none", "availableModes": ["2560x1440@144.00Hz", "2560x1440@60.00Hz", "1920x1080@60.00Hz"]
+}])";
+
+// the getMonitorsInfo parse, with --bench-jsoncpp before and after the pull parser
+auto benchMonitorsParse(int iterations) -> void {
+#ifdef BENCH_JSONCPP
+    reportWithAllocations("monitors (jsoncpp DOM)", iterations, [] {
+        std::istringstream stream{std::string(SAMPLE_MONITORS)};
+        Json::Value data;
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        Json::parseFromStream(builder, stream, &data, &errors);
+        int sum = 0;
+        for (const auto& monitor : data) {
+            sum += monitor["x"].asInt() + monitor["width"].asInt() + static_cast<int>(monitor["name"].asString().size());
+        }
+        return sum;
+    });
+#endif
+
+    reportWithAllocations("monitors (JsonPull)", iterations, [] {
+        JsonPull json(SAMPLE_MONITORS);
+        int sum = 0;
+        json.next();
+        while (json.next() == JsonPull::Token::BeginObject) {
+            while (json.next() == JsonPull::Token::Key) {
+                std::string_view key = json.text();
+                int value = 0;
+                std::string_view name;
+                if (key == "x" || key == "width") {
+                    json.readNumber(value);
+                } else if (key == "name") {
+                    json.readString(name);
+                } else {
+                    json.skipValue();
+                }
+                sum += value + static_cast<int>(name.size());
+            }
+        }
+        return sum;
+    });
+}
+
+// the daemon's footprint on disk, next to this binary by default
+auto reportBinarySize(const char* path) -> void {
+    std::error_code error;
+    std::filesystem::path binary = path ? std::filesystem::path(path)
+                                        : std::filesystem::read_symlink("/proc/self/exe", error).parent_path() / "autowaybar";
+    auto size = std::filesystem::file_size(binary, error);
+    if (error) {
+        log_message(WARN, "Cannot read the size of {}, build autowaybar first\n", binary.string());
+        return;
+    }
+    fmt::print("{:<28} {:>10} bytes ({})\n", "autowaybar binary", size, binary.string());
+}
+
+auto main(int argc, char* argv[]) -> int {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000;
+    if (iterations <= 0) iterations = 1000;
+
+    fmt::print("autowaybar benchmarks, {} iterations\n", iterations);
+    benchCursorPos(iterations);
+    benchSpawn(iterations);
+    benchMonitorsParse(iterations);
+    reportBinarySize(argc > 2 ? argv[2] : nullptr);
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Stand-in for Hyprland's request socket that records every request and
+// answers with a canned reply, used to check the --hypr-hide/--hypr-show
+// backend without a compositor:
+//   xmake build autowaybar-hyprstub && xmake run autowaybar-hyprstub
+// It points HYPRLAND_INSTANCE_SIGNATURE and XDG_RUNTIME_DIR at a scratch
+// directory before the first request, so hyprCommand talks to it instead.
+#include "Hyprland.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+class HyprStub {
+public:
+    explicit HyprStub(const std::string& dir) : m_path(dir + "/.socket.sock") {
+        m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        m_path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+        if (m_fd == -1 || bind(m_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == -1 ||
+            listen(m_fd, 8) == -1) {
+            throw std::runtime_error("Cannot listen on " + m_path + ": " + strerror(errno));
+        }
+        m_thread = std::thread([this] { serve(); });
+    }
+
+    ~HyprStub() {
+        shutdown(m_fd, SHUT_RDWR); // wakes accept()
+        m_thread.join();
+        close(m_fd);
+    }
+
+    auto reply(std::string text) -> void {
+        std::lock_guard lock(m_mutex);
+        m_reply = std::move(text);
+    }
+
+    auto requests() -> std::vector<std::string> {
+        std::lock_guard lock(m_mutex);
+        return std::exchange(m_requests, {});
+    }
+
+private:
+    // one request per connection, like Hyprland; the client never shuts down its side
+    auto serve() -> void {
+        int client;
+        while ((client = accept(m_fd, nullptr, nullptr)) != -1) {
+            char buf[4096];
+            ssize_t bytes = read(client, buf, sizeof(buf));
+            std::string reply;
+            {
+                std::lock_guard lock(m_mutex);
+                m_requests.emplace_back(buf, static_cast<size_t>(std::max<ssize_t>(bytes, 0)));
+                reply = m_reply;
+            }
+            [[maybe_unused]] auto written = write(client, reply.data(), reply.size());
+            close(client);
+        }
+    }
+
+    std::string m_path;
+    int m_fd = -1;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::string m_reply = "ok";
+    std::vector<std::string> m_requests;
+};
+
+static int g_failures = 0;
+
+auto check(bool ok, std::string_view what) -> void {
+    fmt::print("{} {}\n", ok ? "ok  " : "FAIL", what);
+    g_failures += !ok;
+}
+
+auto expectRequests(HyprStub& stub, const std::vector<std::string>& expected, std::string_view what) -> void {
+    auto got = stub.requests();
+    check(got == expected, what);
+    if (got != expected) {
+        for (const auto& request : got) fmt::print("     sent: {}\n", request);
+    }
+}
+
+auto main() -> int {
+    char scratch[] = "/tmp/autowaybar-hyprstub.XXXXXX";
+    if (!mkdtemp(scratch)) {
+        fmt::print(stderr, "mkdtemp: {}\n", strerror(errno));
+        return 1;
+    }
+    const std::string dir = fmt::format("{}/hypr/stub", scratch);
+    std::filesystem::create_directories(dir);
+    setenv("XDG_RUNTIME_DIR", scratch, 1);
+    setenv("HYPRLAND_INSTANCE_SIGNATURE", "stub", 1);
+
+    {
+        HyprStub stub(dir);
+        const hypr_commands_t commands{.hide = "keyword monitor {},addreserved,-30,0,0,0",
+                                       .show = "keyword monitor {},addreserved,0,0,0,0"};
+        const std::vector<std::string> outputs{"DP-1", "HDMI-A-1"};
+        std::vector<std::string> hidden;
+
+        hyprSyncHidden(commands, outputs, {"DP-1"}, hidden);
+        expectRequests(stub, {"[[BATCH]]keyword monitor DP-1,addreserved,-30,0,0,0"}, "hide sends one batch");
+        check(hidden == std::vector<std::string>{"DP-1"}, "accepted hide is remembered");
+
+        hyprSyncHidden(commands, outputs, {"DP-1"}, hidden);
+        expectRequests(stub, {}, "unchanged state sends nothing");
+
+        hyprSyncHidden(commands, outputs, {"HDMI-A-1"}, hidden);
+        expectRequests(stub, {"[[BATCH]]keyword monitor DP-1,addreserved,0,0,0,0;"
+                              "keyword monitor HDMI-A-1,addreserved,-30,0,0,0"}, "show and hide share a batch");
+        check(hidden == std::vector<std::string>{"HDMI-A-1"}, "both changes are remembered");
+
+        stub.reply("ok\n\ninvalid monitor");
+        hyprSyncHidden(commands, outputs, {}, hidden);
+        expectRequests(stub, {"[[BATCH]]keyword monitor HDMI-A-1,addreserved,0,0,0,0"}, "show sends one batch");
+        check(hidden == std::vector<std::string>{"HDMI-A-1"}, "rejected batch leaves the hidden set alone");
+
+        stub.reply("ok");
+        hyprSyncHidden(commands, outputs, {}, hidden);
+        expectRequests(stub, {"[[BATCH]]keyword monitor HDMI-A-1,addreserved,0,0,0,0"}, "rejected batch is sent again");
+        check(hidden.empty(), "retried show is remembered");
+
+        hidden = {"HDMI-A-1"};
+        hyprSyncHidden(commands, {"DP-1"}, {}, hidden);
+        expectRequests(stub, {}, "unplugged monitors are forgotten, not shown");
+        check(hidden.empty(), "unplugged monitor left the hidden set");
+    }
+    std::filesystem::remove_all(scratch);
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+// Checks which input JsonPull accepts in strict mode (hyprctl replies) and
+// with comments enabled (waybar's JSONC configs):
+//   xmake build autowaybar-jsonpull-check && xmake run autowaybar-jsonpull-check
+#include "jsonpull.hpp"
+#include <fmt/core.h>
+#include <string_view>
+
+static int g_failures = 0;
+
+auto check(bool ok, std::string_view what) -> void {
+    fmt::print("{} {}\n", ok ? "ok  " : "FAIL", what);
+    g_failures += !ok;
+}
+
+// true when the whole input parses as one value
+auto parses(std::string_view input, bool allow_comments) -> bool {
+    JsonPull json(input, allow_comments);
+    if (!json.skipValue()) return false;
+    return json.next() == JsonPull::Token::End;
+}
+
+auto main() -> int {
+    check(parses(R"({"a": [1, 2], "b": {"c": null}})", false), "strict accepts plain JSON");
+    check(parses("{}", false) && parses("[]", false), "strict accepts empty containers");
+    check(!parses(R"({"a": 1,})", false), "strict rejects a trailing comma in an object");
+    check(!parses("[1, 2,]", false), "strict rejects a trailing comma in an array");
+    check(!parses(R"([{"a": 1},])", false), "strict rejects a trailing comma after a nested value");
+    check(!parses("{,}", false) && !parses("[,]", false), "strict rejects a lone comma");
+    check(!parses("// note\n{}", false), "strict rejects comments");
+
+    check(parses(R"({"a": 1,})", true), "JSONC accepts a trailing comma in an object");
+    check(parses("[1, 2,]", true), "JSONC accepts a trailing comma in an array");
+    check(parses("// note\n{\"a\": /* inline */ 1}", true), "JSONC accepts comments");
+    check(!parses("{,}", true) && !parses("[1,,]", true), "JSONC rejects empty members");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+// Offline evaluation of --predict against cursor traces recorded with
+// --record-trace. Each trace is replayed twice, once the way the bar reveals
+// without prediction (zone plus activation delay) and once with the
+// predictor in front of it:
+//   xmake build autowaybar-replay && xmake run autowaybar-replay [options] trace...
+#include "predictor.hpp"
+#include <algorithm>
+#include <fmt/core.h>
+#include <fstream>
+#include <getopt.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+// put between the runs of the daemon appended to one trace, longer than the daemon ever waits for a sample
+constexpr auto SESSION_GAP = seconds(10);
+
+struct trace_sample_t {
+    microseconds at{};
+    int x = 0, y = 0;
+    int monitor = -1;
+    int zone_edge = -1; // last row of the activation zone on that monitor
+
+    auto distance() const -> int { return std::max(0, y - zone_edge); }
+    auto inZone() const -> bool { return monitor >= 0 && y <= zone_edge; }
+};
+
+// one arrival in the zone
+struct reach_t {
+    microseconds at{};
+    microseconds baseline{-1};  // reveal without prediction after the arrival, -1 when it left too soon
+    microseconds predicted{-1}; // the early reveal that was up when the cursor arrived, -1 when none
+};
+
+struct replay_result_t {
+    std::vector<reach_t> reaches{};
+    int predictions = 0;
+    int false_reveals = 0;
+    microseconds duration{};
+    size_t samples = 0;
+};
+
+auto loadTrace(const std::string& path) -> std::vector<trace_sample_t> {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open trace " + path);
+    }
+    std::vector<trace_sample_t> samples;
+    std::string line;
+    microseconds session{}; // every run of the daemon appends a header and starts its clock over, see SESSION_GAP
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+            if (!samples.empty()) session = samples.back().at + SESSION_GAP;
+            continue;
+        }
+        std::istringstream fields(line);
+        long long at;
+        trace_sample_t sample;
+        if (fields >> at >> sample.x >> sample.y >> sample.monitor >> sample.zone_edge) {
+            sample.at = session + microseconds(at);
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+auto replay(const std::vector<trace_sample_t>& samples, const reveal_predictor_config_t& config,
+            milliseconds arm_delay) -> replay_result_t {
+    replay_result_t result;
+    result.samples = samples.size();
+    if (samples.empty()) return result;
+    for (size_t i = 1; i < samples.size(); ++i) {
+        const auto gap = samples[i].at - samples[i - 1].at;
+        result.duration += gap < SESSION_GAP ? gap : microseconds{};
+    }
+
+    RevealPredictor predictor(config);
+    bool was_in_zone = false;
+    microseconds pending{-1}; // an early reveal waiting for the cursor
+    for (const auto& sample : samples) {
+        const RevealPredictor::Clock::time_point at(sample.at);
+        const bool in_zone = sample.inZone();
+
+        if (pending.count() >= 0 && sample.at - pending > config.hold && !in_zone) {
+            ++result.false_reveals;
+            pending = microseconds(-1);
+        }
+        if (predictor.update(at, sample.monitor, sample.monitor < 0 ? 0 : sample.distance()) && pending.count() < 0) {
+            ++result.predictions;
+            pending = sample.at;
+        }
+
+        if (in_zone && !was_in_zone) {
+            result.reaches.push_back({.at = sample.at, .predicted = pending});
+            pending = microseconds(-1);
+        }
+        if (in_zone && !result.reaches.empty()) {
+            auto& reach = result.reaches.back();
+            if (reach.baseline.count() < 0 && sample.at - reach.at >= arm_delay) {
+                reach.baseline = sample.at;
+            }
+        }
+        was_in_zone = in_zone;
+    }
+    if (pending.count() >= 0) {
+        ++result.false_reveals; // the trace ended before the cursor got there
+    }
+    return result;
+}
+
+auto percentile(std::vector<double> values, double p) -> double {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+auto mean(const std::vector<double>& values) -> double {
+    double sum = 0;
+    for (double value : values) sum += value;
+    return values.empty() ? 0 : sum / values.size();
+}
+
+// Latency is from the cursor's arrival in the zone to the reveal, negative
+// when the bar was already up. Arrivals that the activation delay rejects
+// (the cursor left again) only count when the predictor revealed them.
+auto report(std::string_view name, const replay_result_t& result) -> void {
+    std::vector<double> baseline, predicted;
+    int early = 0, brushes = 0;
+    for (const auto& reach : result.reaches) {
+        if (reach.baseline.count() < 0) {
+            brushes += reach.predicted.count() >= 0;
+            continue;
+        }
+        const double without = duration<double, std::milli>(reach.baseline - reach.at).count();
+        baseline.push_back(without);
+        if (reach.predicted.count() >= 0) {
+            ++early;
+            predicted.push_back(duration<double, std::milli>(reach.predicted - reach.at).count());
+        } else {
+            predicted.push_back(without);
+        }
+    }
+
+    const double minutes = std::max(duration<double>(result.duration).count() / 60, 1.0 / 60);
+    fmt::print("{}: {} samples over {:.1f}s, {} reveals, {} arrivals too short to reveal\n", name, result.samples,
+               duration<double>(result.duration).count(), baseline.size(), result.reaches.size() - baseline.size());
+    fmt::print("  {:<10} latency mean {:>7.1f}ms  p50 {:>7.1f}ms  p95 {:>7.1f}ms\n", "baseline", mean(baseline),
+               percentile(baseline, 0.5), percentile(baseline, 0.95));
+    fmt::print("  {:<10} latency mean {:>7.1f}ms  p50 {:>7.1f}ms  p95 {:>7.1f}ms  ({} early)\n", "predicted",
+               mean(predicted), percentile(predicted, 0.5), percentile(predicted, 0.95), early);
+    fmt::print("  {} predictions, {} false ({:.1f}%, {:.2f}/min), {} for arrivals the delay would reject\n",
+               result.predictions, result.false_reveals,
+               result.predictions ? 100.0 * result.false_reveals / result.predictions : 0.0,
+               result.false_reveals / minutes, brushes);
+}
+
+auto usage() -> void {
+    fmt::print("usage: autowaybar-replay [options] trace...\n"
+               "  -d ms   activation delay without prediction (default 250, 0 for focused and mon: modes)\n"
+               "  -a A    alpha, position gain\n"
+               "  -b B    beta, velocity gain\n"
+               "  -H ms   prediction horizon\n"
+               "  -s px   minimum speed in px/ms\n"
+               "  -m px   farthest distance from the zone\n"
+               "  -B px   most braking in px/ms² that still counts as heading for the edge\n"
+               "  -c n    samples that must agree\n"
+               "  -o ms   hold of an early reveal\n");
+}
+
+auto main(int argc, char* argv[]) -> int {
+    reveal_predictor_config_t config;
+    milliseconds arm_delay(250);
+    int opt;
+    try {
+        while ((opt = getopt(argc, argv, "d:a:b:H:s:m:B:c:o:h")) != -1) {
+            switch (opt) {
+            case 'd': arm_delay = milliseconds(std::stoi(optarg)); break;
+            case 'a': config.alpha = std::stod(optarg); break;
+            case 'b': config.beta = std::stod(optarg); break;
+            case 'H': config.horizon = milliseconds(std::stoi(optarg)); break;
+            case 's': config.min_speed = std::stod(optarg); break;
+            case 'm': config.max_distance = std::stoi(optarg); break;
+            case 'B': config.max_braking = std::stod(optarg); break;
+            case 'c': config.confirm = std::stoi(optarg); break;
+            case 'o': config.hold = milliseconds(std::stoi(optarg)); break;
+            default: usage(); return opt == 'h' ? 0 : 1;
+            }
+        }
+    } catch (const std::exception&) {
+        fmt::print(stderr, "invalid value for -{}: {}\n", static_cast<char>(opt), optarg);
+        return 1;
+    }
+    if (optind == argc) {
+        usage();
+        return 1;
+    }
+
+    replay_result_t total;
+    for (int i = optind; i < argc; ++i) {
+        try {
+            auto result = replay(loadTrace(argv[i]), config, arm_delay);
+            report(argv[i], result);
+            total.reaches.insert(total.reaches.end(), result.reaches.begin(), result.reaches.end());
+            total.predictions += result.predictions;
+            total.false_reveals += result.false_reveals;
+            total.duration += result.duration;
+            total.samples += result.samples;
+        } catch (const std::exception& e) {
+            fmt::print(stderr, "{}\n", e.what());
+            return 1;
+        }
+    }
+    if (argc - optind > 1) {
+        report("total", total);
+    }
+    return 0;
+}
@@ -65,17 +65,13 @@ check_dependencies() {
         missing_deps+=("libfmt-dev")
     fi
     
-    if ! pkg-config --exists jsoncpp; then
-        missing_deps+=("libjsoncpp-dev")
-    fi
-    
     if [ ${#missing_deps[@]} -ne 0 ]; then
         print_error "Missing dependencies: ${missing_deps[*]}"
         echo ""
         echo "Install with:"
-        echo "  Arch Linux: sudo pacman -S gcc xmake fmt jsoncpp"
-        echo "  Ubuntu/Debian: sudo apt install build-essential xmake libfmt-dev libjsoncpp-dev"
-        echo "  Fedora: sudo dnf install gcc-c++ xmake fmt-devel jsoncpp-devel"
+        echo "  Arch Linux: sudo pacman -S gcc xmake fmt"
+        echo "  Ubuntu/Debian: sudo apt install build-essential xmake libfmt-dev"
+        echo "  Fedora: sudo dnf install gcc-c++ xmake fmt-devel"
         exit 1
     fi
     
@@ -114,7 +110,7 @@ build_manual() {
     local sources=$(find src -name "*.cpp" | tr '\n' ' ')
     
     # Compile
-    g++ $flags $sources -o autowaybar -lfmt -ljsoncpp
+    g++ $flags $sources -o autowaybar -lfmt
     
     print_success "Manual build completed"
 }
@@ -230,7 +226,6 @@ show_help() {
     echo "  - g++ (C++20 support)"
     echo "  - xmake (optional, for xmake build)"
     echo "  - fmt library"
-    echo "  - jsoncpp library"
 }
 
 # Main script logic
@@ -1,13 +1,257 @@
 #include "Hyprland.hpp"
+#include "jsonpull.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <functional>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 // Exclusive for Hyprland, wont work with other WM
 
+// Builds the address of a Hyprland IPC socket. Hyprland >= 0.40 lives under
+// $XDG_RUNTIME_DIR/hypr, older versions under /tmp/hypr.
+auto hyprInstanceDir() -> std::string {
+    const char* signature = std::getenv("HYPRLAND_INSTANCE_SIGNATURE");
+    if (!signature) return {};
+
+    // Hyprland >= 0.40 uses $XDG_RUNTIME_DIR, older versions /tmp. Prefer the
+    // former unless only /tmp exists, so a lookup made before the compositor
+    // created its sockets still picks the right place.
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    std::string dir = fmt::format("{}/hypr/{}", runtime_dir ? runtime_dir : "/tmp", signature);
+    std::string legacy = fmt::format("/tmp/hypr/{}", signature);
+    if (access(dir.c_str(), F_OK) != 0 && access(legacy.c_str(), F_OK) == 0) {
+        return legacy;
+    }
+    return dir;
+}
+
+static auto hyprSocketAddr(std::string_view name) -> sockaddr_un {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    std::string dir = hyprInstanceDir();
+    if (dir.empty()) return addr; // empty sun_path: no socket available
+
+    std::string path = fmt::format("{}/{}", dir, name);
+    if (path.size() < sizeof(addr.sun_path)) {
+        std::copy(path.begin(), path.end(), addr.sun_path);
+    }
+    return addr;
+}
+
+// Connects to the request socket, one connection per request as Hyprland expects
+static auto hyprConnect() -> int {
+    static const sockaddr_un addr = hyprSocketAddr(".socket.sock");
+    if (addr.sun_path[0] == '\0') return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return -1;
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends a request and reads the reply into buf. Returns bytes read or -1.
+// MSG_NOSIGNAL: a compositor that closes early must not SIGPIPE the daemon.
+auto hyprRequest(std::string_view request, char* buf, std::size_t size) -> ssize_t {
+    int fd = hyprConnect();
+    if (fd == -1) return -1;
+
+    ssize_t total = -1;
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+        total = 0;
+        ssize_t bytes_read;
+        while (static_cast<std::size_t>(total) < size &&
+               (bytes_read = read(fd, buf + total, size - total)) > 0) {
+            total += bytes_read;
+        }
+    }
+    close(fd);
+    return total;
+}
+
+// Cursor, active workspace and active monitor in one round trip.
+// Returns false when the socket is not reachable so the caller can fall back.
+auto getHyprSnapshot(HyprSnapshot& snap) -> bool {
+    char buf[1024];
+    ssize_t bytes = hyprRequest("[[BATCH]]cursorpos;j/activeworkspace", buf, sizeof(buf));
+    if (bytes <= 0) return false;
+
+    std::string_view reply(buf, static_cast<size_t>(bytes));
+    std::tie(snap.cursor_x, snap.cursor_y) = parseCursorPos(reply);
+
+    // the j/activeworkspace object follows the cursor reply
+    size_t object = reply.find('{');
+    if (object == std::string_view::npos) return true;
+    JsonPull json(reply.substr(object));
+    if (json.next() != JsonPull::Token::BeginObject) return true;
+    while (json.next() == JsonPull::Token::Key) {
+        std::string_view key = json.text();
+        std::string_view monitor;
+        if (key == "id") {
+            if (!json.readNumber(snap.workspace)) break;
+        } else if (key == "monitor") {
+            if (!json.readString(monitor)) break;
+            size_t len = std::min(monitor.size(), snap.monitor.size() - 1);
+            std::copy_n(monitor.data(), len, snap.monitor.data());
+            snap.monitor[len] = '\0';
+        } else if (!json.skipValue()) {
+            break;
+        }
+    }
+    return true;
+}
+
+// Opens the non-blocking event socket, -1 when it is not available
+auto hyprConnectEvents() -> int {
+    static const sockaddr_un addr = hyprSocketAddr(".socket2.sock");
+    if (addr.sun_path[0] == '\0') return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd == -1) return -1;
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Drains pending "EVENT>>DATA\n" lines and calls on_event for each complete one.
+// Returns false when the compositor closed the stream.
+auto readHyprEvents(hypr_event_stream_t& stream,
+                    const std::function<void(std::string_view, std::string_view)>& on_event) -> bool {
+    while (true) {
+        ssize_t bytes_read = read(stream.fd, stream.buf.data() + stream.len, stream.buf.size() - stream.len);
+        if (bytes_read == 0) return false;
+        if (bytes_read < 0) return errno == EAGAIN || errno == EINTR;
+        stream.len += bytes_read;
+
+        std::string_view pending(stream.buf.data(), stream.len);
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string_view::npos) {
+            std::string_view line = pending.substr(0, newline);
+            size_t sep = line.find(">>");
+            if (sep != std::string_view::npos) {
+                on_event(line.substr(0, sep), line.substr(sep + 2));
+            }
+            pending.remove_prefix(newline + 1);
+        }
+
+        // keep the partial line; a line longer than the buffer is dropped
+        if (pending.size() == stream.buf.size()) pending = {};
+        std::copy(pending.begin(), pending.end(), stream.buf.data());
+        stream.len = pending.size();
+    }
+}
+
+// Same as hyprRequest but for replies of unknown size. Empty on failure.
+auto hyprQuery(std::string_view request) -> std::string {
+    int fd = hyprConnect();
+    if (fd == -1) return {};
+
+    std::string result;
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+        constexpr size_t CHUNK_SIZE = 4096;
+        ssize_t bytes_read;
+        do {
+            size_t old_size = result.size();
+            result.resize(old_size + CHUNK_SIZE);
+            bytes_read = read(fd, result.data() + old_size, CHUNK_SIZE);
+            result.resize(old_size + std::max<ssize_t>(bytes_read, 0));
+        } while (bytes_read > 0);
+    }
+    close(fd);
+    return result;
+}
+
+// Sends ';' separated keyword/dispatch commands as one [[BATCH]] request.
+// Hyprland answers "ok" per command; anything else is its error text.
+auto hyprCommand(std::string_view commands) -> bool {
+    std::string reply = hyprQuery(fmt::format("[[BATCH]]{}", commands));
+    if (reply.empty()) {
+        log_message(WARN, "Hyprland did not answer '{}'\n", commands);
+        return false;
+    }
+    std::string_view rest(reply);
+    while (!rest.empty()) {
+        if (rest.front() == '\n' || rest.front() == ' ') {
+            rest.remove_prefix(1);
+        } else if (rest.starts_with("ok")) {
+            rest.remove_prefix(2);
+        } else {
+            log_message(WARN, "Hyprland rejected '{}': {}\n", commands, rest);
+            return false;
+        }
+    }
+    return true;
+}
+
+// --hypr-hide/--hypr-show for every monitor in `outputs` whose wanted state
+// differs from `hidden`, the monitors the compositor last accepted a hide
+// for, as one batch with "{}" replaced by the name. `hidden` only becomes
+// `wanted` when every command answered "ok", so a rejected batch is sent
+// again next time. Returns the batch, empty when nothing changed.
+auto hyprSyncHidden(const hypr_commands_t& commands, const std::vector<std::string>& outputs,
+                    const std::vector<std::string>& wanted, std::vector<std::string>& hidden) -> std::string {
+    auto contains = [](const std::vector<std::string>& names, const std::string& name) {
+        return std::find(names.cbegin(), names.cend(), name) != names.cend();
+    };
+    std::erase_if(hidden, [&](const std::string& name) { return !contains(outputs, name); });
+
+    std::string batch;
+    auto append = [&batch](std::string_view command, std::string_view name) {
+        if (!batch.empty()) batch.push_back(';');
+        size_t from = 0, at;
+        while ((at = command.find("{}", from)) != std::string_view::npos) {
+            batch.append(command.substr(from, at - from)).append(name);
+            from = at + 2;
+        }
+        batch.append(command.substr(from));
+    };
+    for (const auto& name : outputs) {
+        const bool hide = contains(wanted, name);
+        if (hide != contains(hidden, name)) append(hide ? commands.hide : commands.show, name);
+    }
+    if (!batch.empty() && hyprCommand(batch)) {
+        hidden = wanted;
+    }
+    return batch;
+}
+
+// Parses "x, y" as printed by cursorpos
+auto parseCursorPos(std::string_view reply) -> std::pair<int, int> {
+    const char* ptr = reply.data();
+    const char* end = reply.data() + reply.size();
+    int xpos = 0, ypos = 0;
+
+    auto [x_end, x_err] = std::from_chars(ptr, end, xpos);
+    if (x_err != std::errc{}) return {-1, -1};
+    ptr = x_end;
+    while (ptr < end && (*ptr == ',' || *ptr == ' ')) ++ptr;
+
+    auto [y_end, y_err] = std::from_chars(ptr, end, ypos);
+    if (y_err != std::errc{}) return {-1, -1};
+    return {xpos, ypos};
+}
+
 // Check if we're running in Hyprland - fail fast if not
 auto isHyprlandRunning() -> bool {
     const char* session = std::getenv("XDG_SESSION_DESKTOP");
     return session && std::string(session) == "Hyprland";
 }
 
+// The compositor answers on its socket and has at least one monitor
+auto hyprHasMonitors() -> bool {
+    char buf[256];
+    ssize_t bytes = hyprRequest("j/monitors", buf, sizeof(buf));
+    return bytes > 0 && std::string_view(buf, static_cast<size_t>(bytes)).find("\"name\"") != std::string_view::npos;
+}
+
 // returns cursor x and y coords
 auto getCursorPos() -> std::pair<int, int> {
     if (!isHyprlandRunning()) {
@@ -16,22 +260,21 @@ auto getCursorPos() -> std::pair<int, int> {
         throw std::runtime_error("This tool only works with Hyprland. Current session: " + session_str);
     }
     
+    // Fast path: ask the compositor directly, no allocation
+    char buf[64];
+    ssize_t bytes = hyprRequest("cursorpos", buf, sizeof(buf));
+    if (bytes > 0) {
+        return parseCursorPos({buf, static_cast<size_t>(bytes)});
+    }
+
     const std::string_view cmd = "/usr/bin/hyprctl cursorpos";
     std::string result = execute_command(cmd);
     
     if (result.empty()) {
         return std::pair<int, int>{-1, -1};
     }
-    
-    std::istringstream stream(result);
-    int xpos, ypos;
-    char separator;
-    
-    if (stream >> xpos >> separator >> ypos) {
-        return std::pair<int, int>{xpos, ypos};
-    }
 
-    return std::pair<int, int>{-1, -1};
+    return parseCursorPos(result);
 }
 
 // returns a vector with the monitor information provided by Hyprland
@@ -42,45 +285,67 @@ auto getMonitorsInfo() -> std::vector<monitor_info_t> {
         throw std::runtime_error("This tool only works with Hyprland. Current session: " + session_str);
     }
     
-    const std::string_view cmd = "/usr/bin/hyprctl monitors all -j";
-    std::string result = execute_command(cmd);
+    std::string result = hyprQuery("j/monitors all");
+    if (result.empty()) {
+        const std::string_view cmd = "/usr/bin/hyprctl monitors all -j";
+        result = execute_command(cmd);
+    }
     
     if (result.empty()) {
         throw std::runtime_error("Failed to get monitor information from hyprctl");
     }
     
-    std::istringstream stream(result);
-    Json::Value data;
-    Json::CharReaderBuilder builder;
-    std::string errors;
-    
-    if (!Json::parseFromStream(builder, stream, &data, &errors)) {
-        throw std::runtime_error("Invalid JSON response from hyprctl: " + errors);
-    }
-
-    if (!data.isArray()) {
+    // Pull only the fields we use, the rest of each monitor object is skipped
+    JsonPull json(result);
+    if (json.next() != JsonPull::Token::BeginArray) {
         throw std::runtime_error("Invalid JSON structure from hyprctl");
     }
 
-        std::vector<monitor_info_t> monitors;
-        monitors.reserve(data.size());
-
-        for (const auto& monitor : data) {
-            monitor_info_t temp;
-            temp.name = monitor["name"].asString();
-            temp.x_coord = monitor["x"].asInt();
-            temp.y_coord = monitor["y"].asInt();
-            
-            float scale = monitor["scale"].empty() ? 1.0f : monitor["scale"].asFloat();
-            temp.width = static_cast<int>(monitor["width"].asInt() / scale);
-            temp.height = static_cast<int>(monitor["height"].asInt() / scale);
-
-            log_message(LOG,
-                "Monitor named {} found in x: {}, y: {}, width: {}, height: {}. \n",
-                temp.name, temp.x_coord, temp.y_coord, temp.width, temp.height
-            );
-            monitors.push_back(temp);
+    std::vector<monitor_info_t> monitors;
+    JsonPull::Token token;
+    while ((token = json.next()) == JsonPull::Token::BeginObject) {
+        monitor_info_t temp;
+        int width = 0, height = 0;
+        double scale = 1.0;
+        bool ok = true;
+        while (ok && (token = json.next()) == JsonPull::Token::Key) {
+            std::string_view key = json.text();
+            if (key == "name") {
+                std::string_view name;
+                ok = json.readString(name);
+                temp.name = name;
+            } else if (key == "x") {
+                ok = json.readNumber(temp.x_coord);
+            } else if (key == "y") {
+                ok = json.readNumber(temp.y_coord);
+            } else if (key == "width") {
+                ok = json.readNumber(width);
+            } else if (key == "height") {
+                ok = json.readNumber(height);
+            } else if (key == "scale") {
+                ok = json.readNumber(scale);
+            } else {
+                ok = json.skipValue();
+            }
         }
+        if (!ok || token != JsonPull::Token::EndObject) {
+            throw std::runtime_error("Invalid JSON response from hyprctl near offset " + std::to_string(json.offset()));
+        }
+
+        if (scale <= 0.0) scale = 1.0;
+        temp.width = static_cast<int>(width / scale);
+        temp.height = static_cast<int>(height / scale);
 
-        return monitors;
+        log_message(LOG,
+            "Monitor named {} found in x: {}, y: {}, width: {}, height: {}. \n",
+            temp.name, temp.x_coord, temp.y_coord, temp.width, temp.height
+        );
+        monitors.push_back(std::move(temp));
     }
+    if (token != JsonPull::Token::EndArray) {
+        throw std::runtime_error("Invalid JSON response from hyprctl near offset " + std::to_string(json.offset()));
+    }
+
+    return monitors;
+
+}
@@ -1,6 +1,23 @@
 #include "waybar.hpp"
+#include <functional>
 
 // Exclusive functions for Hyprland, wont work with other compositor
 auto isHyprlandRunning() -> bool;
 auto getCursorPos() -> std::pair<int, int>;
 auto getMonitorsInfo() -> std::vector<monitor_info_t>;
+auto hyprHasMonitors() -> bool;
+auto hyprInstanceDir() -> std::string; // directory holding the IPC sockets, empty outside Hyprland
+
+// Hyprland IPC socket (.socket.sock), hyprctl is only the fallback
+auto hyprRequest(std::string_view request, char* buf, std::size_t size) -> ssize_t;
+auto hyprQuery(std::string_view request) -> std::string;
+auto hyprCommand(std::string_view commands) -> bool; // keyword/dispatch batch, true when all replied "ok"
+auto hyprSyncHidden(const hypr_commands_t& commands, const std::vector<std::string>& outputs,
+                    const std::vector<std::string>& wanted, std::vector<std::string>& hidden) -> std::string;
+auto parseCursorPos(std::string_view reply) -> std::pair<int, int>;
+auto getHyprSnapshot(HyprSnapshot& snap) -> bool;
+
+// Hyprland event socket (.socket2.sock)
+auto hyprConnectEvents() -> int;
+auto readHyprEvents(hypr_event_stream_t& stream,
+                    const std::function<void(std::string_view, std::string_view)>& on_event) -> bool;
@@ -0,0 +1,76 @@
+#include "intents.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+IntentQueue::IntentQueue(size_t capacity) {
+    const size_t size = std::bit_ceil(std::max<size_t>(capacity, 2));
+    m_cells = std::make_unique<Cell[]>(size);
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_event_fd == -1) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+}
+
+IntentQueue::~IntentQueue() {
+    close(m_event_fd);
+}
+
+// A cell is free for position p when its sequence is p, and readable when
+// it is p + 1; the consumer hands it back for the next lap as p + size
+auto IntentQueue::post(waybar_intent_t intent) -> bool {
+    bool posted = false;
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = m_cells[pos & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.intent = intent;
+                cell.sequence.store(pos + 1, std::memory_order_seq_cst);
+                posted = true;
+                break;
+            }
+        } else if (diff < 0) {
+            m_overflowed.store(true, std::memory_order_relaxed); // the consumer still gets woken, to resync
+            break;
+        } else {
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+    // seq_cst against the consumer's reset: either it sees this intent, or we see the reset
+    if (!m_woken.exchange(true, std::memory_order_seq_cst)) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] auto written = write(m_event_fd, &one, sizeof(one));
+    }
+    return posted;
+}
+
+auto IntentQueue::drain(std::vector<waybar_intent_t>& out) -> bool {
+    // the loop also drains right after its own posts, without a syscall when nobody woke it
+    if (m_woken.exchange(false, std::memory_order_seq_cst)) {
+        std::uint64_t count;
+        [[maybe_unused]] auto n = read(m_event_fd, &count, sizeof(count));
+    }
+
+    for (;;) {
+        Cell& cell = m_cells[m_head & m_mask];
+        if (cell.sequence.load(std::memory_order_seq_cst) != m_head + 1) {
+            break;
+        }
+        out.push_back(cell.intent);
+        cell.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+        ++m_head;
+    }
+    return m_overflowed.exchange(false, std::memory_order_acquire);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// What a producer wants done to one waybar instance
+enum class WaybarIntent : std::uint8_t {
+    Show,
+    Hide,
+    Reload  // its config changed; hidden instances pick it up when shown
+};
+
+struct waybar_intent_t {
+    std::uint32_t instance = 0;  // waybar_instance_t::id, stable while the pool changes
+    WaybarIntent kind = WaybarIntent::Show;
+};
+
+// Bounded MPSC queue of intents, one slot per sequence number (Vyukov's
+// ring): posting is a CAS on the tail and never blocks or allocates, so any
+// thread may post. The single consumer drains it from the event loop, woken
+// by an eventfd that is written once per batch rather than once per intent.
+class IntentQueue {
+public:
+    explicit IntentQueue(size_t capacity); // rounded up to a power of two
+    ~IntentQueue();
+    IntentQueue(const IntentQueue&) = delete;
+    IntentQueue& operator=(const IntentQueue&) = delete;
+
+    auto fd() const -> int { return m_event_fd; } // readable while intents are waiting
+    auto post(waybar_intent_t intent) -> bool;   // false when full, the consumer is told to resync
+    auto drain(std::vector<waybar_intent_t>& out) -> bool; // consumer only; appends in post order, true after an overflow
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        waybar_intent_t intent;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask = 0;
+    alignas(64) std::atomic<size_t> m_tail{0};  // producers
+    alignas(64) size_t m_head = 0;              // consumer
+    std::atomic<bool> m_woken{false};           // eventfd written since the last drain
+    std::atomic<bool> m_overflowed{false};
+    int m_event_fd = -1;
+};
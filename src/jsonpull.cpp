@@ -0,0 +1,164 @@
+#include "jsonpull.hpp"
+
+auto JsonPull::next() -> Token {
+    while (true) {
+        if (m_error || !skipSpace()) return fail();
+        Frame& frame = m_frames[m_depth];
+        bool at_end = m_pos >= m_input.size();
+        char c = at_end ? '\0' : m_input[m_pos];
+        m_token_begin = m_pos;
+
+        switch (frame.expect) {
+        case Expect::CommaOrEnd:
+            if (m_depth == 0) {
+                return at_end ? Token::End : fail(); // one root value only
+            }
+            if (c == ',') {
+                ++m_pos;
+                // a trailing comma is JSONC, strict JSON needs another member
+                if (m_allow_comments) {
+                    frame.expect = frame.object ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+                } else {
+                    frame.expect = frame.object ? Expect::Key : Expect::Value;
+                }
+                continue;
+            }
+            if (c == '}' && frame.object) return pop(true);
+            if (c == ']' && !frame.object) return pop(false);
+            return fail();
+
+        case Expect::KeyOrEnd:
+            if (c == '}') return pop(true);
+            [[fallthrough]];
+        case Expect::Key:
+            if (c != '"' || !scanString()) return fail();
+            frame.expect = Expect::Colon;
+            return Token::Key;
+
+        case Expect::Colon:
+            if (c != ':') return fail();
+            ++m_pos;
+            frame.expect = Expect::Value;
+            continue;
+
+        case Expect::ValueOrEnd:
+            if (c == ']') return pop(false);
+            [[fallthrough]];
+        case Expect::Value:
+            if (at_end) return fail();
+            frame.expect = Expect::CommaOrEnd;
+            return value();
+        }
+    }
+}
+
+auto JsonPull::value() -> Token {
+    char c = m_input[m_pos];
+    switch (c) {
+    case '{': ++m_pos; return push(true) ? Token::BeginObject : fail();
+    case '[': ++m_pos; return push(false) ? Token::BeginArray : fail();
+    case '"': return scanString() ? Token::String : fail();
+    case 't': return scanLiteral("true", Token::True);
+    case 'f': return scanLiteral("false", Token::False);
+    case 'n': return scanLiteral("null", Token::Null);
+    default: break;
+    }
+
+    size_t start = m_pos;
+    while (m_pos < m_input.size()) {
+        char d = m_input[m_pos];
+        if ((d >= '0' && d <= '9') || d == '-' || d == '+' || d == '.' || d == 'e' || d == 'E') {
+            ++m_pos;
+        } else {
+            break;
+        }
+    }
+    m_text = m_input.substr(start, m_pos - start);
+    double check;
+    return !m_text.empty() && number(check) ? Token::Number : fail();
+}
+
+auto JsonPull::skipValue() -> bool {
+    size_t depth = 0;
+    do {
+        switch (next()) {
+        case Token::BeginObject:
+        case Token::BeginArray: ++depth; break;
+        case Token::EndObject:
+        case Token::EndArray:
+            if (depth == 0) return false; // there was no value to skip
+            --depth;
+            break;
+        case Token::Key: break;
+        case Token::End:
+        case Token::Error: return false;
+        default: break;
+        }
+    } while (depth > 0);
+    return true;
+}
+
+auto JsonPull::readString(std::string_view& out) -> bool {
+    if (next() != Token::String) return false;
+    out = m_text;
+    return true;
+}
+
+auto JsonPull::skipSpace() -> bool {
+    while (m_pos < m_input.size()) {
+        char c = m_input[m_pos];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++m_pos;
+        } else if (c == '/' && m_allow_comments && m_pos + 1 < m_input.size()) {
+            if (m_input[m_pos + 1] == '/') {
+                size_t eol = m_input.find('\n', m_pos);
+                m_pos = eol == std::string_view::npos ? m_input.size() : eol + 1;
+            } else if (m_input[m_pos + 1] == '*') {
+                size_t close = m_input.find("*/", m_pos + 2);
+                if (close == std::string_view::npos) return false;
+                m_pos = close + 2;
+            } else {
+                return true; // stray '/', reported by the caller
+            }
+        } else {
+            return true;
+        }
+    }
+    return true;
+}
+
+auto JsonPull::push(bool object) -> bool {
+    if (m_depth + 1 >= MAX_DEPTH) return false;
+    m_frames[++m_depth] = {.object = object, .expect = object ? Expect::KeyOrEnd : Expect::ValueOrEnd};
+    return true;
+}
+
+auto JsonPull::pop(bool object) -> Token {
+    ++m_pos;
+    --m_depth; // the parent already expects CommaOrEnd
+    return object ? Token::EndObject : Token::EndArray;
+}
+
+auto JsonPull::scanString() -> bool {
+    size_t start = ++m_pos;
+    while (m_pos < m_input.size()) {
+        char c = m_input[m_pos];
+        if (c == '\\') {
+            m_pos += 2;
+        } else if (c == '"') {
+            m_text = m_input.substr(start, m_pos - start);
+            ++m_pos;
+            return true;
+        } else {
+            ++m_pos;
+        }
+    }
+    return false;
+}
+
+auto JsonPull::scanLiteral(std::string_view word, Token token) -> Token {
+    if (m_input.substr(m_pos, word.size()) != word) return fail();
+    m_text = m_input.substr(m_pos, word.size());
+    m_pos += word.size();
+    return token;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+
+// Pull parser over a string_view: the caller asks for one token at a time
+// and skips what it does not need. Nothing is copied or allocated; keys and
+// strings are views into the input with escapes left as written.
+// Accepts JSONC (comments, trailing commas) when comments are enabled.
+class JsonPull {
+public:
+    enum class Token {
+        BeginObject, EndObject, BeginArray, EndArray,
+        Key, String, Number, True, False, Null,
+        End,   // input exhausted after the root value
+        Error, // malformed input, sticky
+    };
+
+    explicit JsonPull(std::string_view input, bool allow_comments = false)
+        : m_input(input), m_allow_comments(allow_comments) {}
+
+    auto next() -> Token;
+    auto skipValue() -> bool;               // skips the next value, nested containers included
+    auto text() const -> std::string_view { return m_text; } // Key/String without quotes, Number as written
+    auto offset() const -> size_t { return m_pos; }          // input position right after the last token
+    auto tokenBegin() const -> size_t { return m_token_begin; } // input position of the last token
+
+    template <typename T>
+    auto number(T& out) const -> bool {
+        auto [end, ec] = std::from_chars(m_text.data(), m_text.data() + m_text.size(), out);
+        return ec == std::errc{} && end == m_text.data() + m_text.size();
+    }
+
+    // next token must be a number / string, read into out
+    template <typename T>
+    auto readNumber(T& out) -> bool { return next() == Token::Number && number(out); }
+    auto readString(std::string_view& out) -> bool;
+
+private:
+    enum class Expect { Value, ValueOrEnd, Key, KeyOrEnd, Colon, CommaOrEnd };
+    struct Frame {
+        bool object = false;
+        Expect expect = Expect::Value;
+    };
+    static constexpr size_t MAX_DEPTH = 32;
+
+    auto skipSpace() -> bool;
+    auto value() -> Token;
+    auto push(bool object) -> bool;
+    auto pop(bool object) -> Token;
+    auto scanString() -> bool;
+    auto scanLiteral(std::string_view word, Token token) -> Token;
+    auto fail() -> Token { m_error = true; return Token::Error; }
+
+    std::string_view m_input;
+    std::string_view m_text{};
+    size_t m_pos = 0;
+    size_t m_token_begin = 0;
+    bool m_allow_comments = false;
+    bool m_error = false;
+    std::array<Frame, MAX_DEPTH> m_frames{}; // [0] is the root
+    size_t m_depth = 0;
+};
@@ -0,0 +1,178 @@
+#include "loop.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+EventLoop::EventLoop() {
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1) {
+        throw std::runtime_error("Failed to create epoll instance: " + std::string(strerror(errno)));
+    }
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_timer_fd == -1) {
+        close(m_epoll_fd);
+        throw std::runtime_error("Failed to create timerfd: " + std::string(strerror(errno)));
+    }
+    m_owned_fds.push_back(m_timer_fd);
+    watch(m_timer_fd, [this] { expireTimers(); });
+    m_tick_timer = addTimer([this] { m_tick_expired = true; });
+}
+
+EventLoop::~EventLoop() {
+    for (int fd : m_owned_fds) {
+        close(fd);
+    }
+    close(m_epoll_fd);
+}
+
+auto EventLoop::watch(int fd, Callback on_readable) -> void {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        throw std::runtime_error("Failed to watch fd " + std::to_string(fd) + ": " + strerror(errno));
+    }
+    m_handlers.push_back(std::make_unique<Handler>(Handler{fd, std::move(on_readable)}));
+}
+
+// Removal is deferred to waitUntil so a callback can unwatch its own fd
+auto EventLoop::unwatch(int fd) -> void {
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    for (auto& handler : m_handlers) {
+        if (handler->fd == fd) handler->fd = -1;
+    }
+}
+
+// Blocks the signals so they are only delivered through the signalfd.
+// Spawned children must unblock them again (see unblock_signals).
+auto EventLoop::watchSignals(std::initializer_list<int> signals, std::function<void(int)> on_signal) -> void {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int sig : signals) sigaddset(&mask, sig);
+    if (sigprocmask(SIG_BLOCK, &mask, nullptr) == -1) {
+        throw std::runtime_error("Failed to block signals: " + std::string(strerror(errno)));
+    }
+
+    int fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to create signalfd: " + std::string(strerror(errno)));
+    }
+    m_owned_fds.push_back(fd);
+    watch(fd, [fd, on_signal = std::move(on_signal)] {
+        signalfd_siginfo info;
+        while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+            on_signal(static_cast<int>(info.ssi_signo));
+        }
+    });
+}
+
+auto EventLoop::addTimer(Callback on_expire) -> int {
+    m_timers.push_back({std::move(on_expire)});
+    return static_cast<int>(m_timers.size() - 1);
+}
+
+// Re-arming leaves the old entry in the heap as garbage; the heap is rebuilt
+// once garbage dominates, so timers re-armed on every event stay O(log n)
+auto EventLoop::armTimer(int timer, Clock::time_point deadline) -> void {
+    auto generation = ++m_timers[timer].generation;
+    m_timer_heap.push_back({deadline, timer, generation});
+    std::push_heap(m_timer_heap.begin(), m_timer_heap.end(), later);
+    if (m_timer_heap.size() > 4 * m_timers.size() + 16) {
+        std::erase_if(m_timer_heap, [this](const TimerEntry& entry) { return !isLive(entry); });
+        std::make_heap(m_timer_heap.begin(), m_timer_heap.end(), later);
+    }
+    scheduleTimerFd();
+}
+
+auto EventLoop::disarmTimer(int timer) -> void {
+    ++m_timers[timer].generation;
+    scheduleTimerFd();
+}
+
+// Absolute deadline, so time spent in callbacks does not stretch the interval
+auto EventLoop::scheduleTimerFd() -> void {
+    while (!m_timer_heap.empty() && !isLive(m_timer_heap.front())) {
+        std::pop_heap(m_timer_heap.begin(), m_timer_heap.end(), later);
+        m_timer_heap.pop_back();
+    }
+    const auto deadline = m_timer_heap.empty() ? Clock::time_point::max() : m_timer_heap.front().deadline;
+    if (deadline == m_timer_fd_deadline) {
+        return;
+    }
+    m_timer_fd_deadline = deadline;
+
+    itimerspec spec{};
+    if (!m_timer_heap.empty()) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        spec.it_value.tv_sec = ns / 1'000'000'000;
+        spec.it_value.tv_nsec = ns % 1'000'000'000;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+            spec.it_value.tv_nsec = 1; // all zero would disarm
+        }
+    }
+    timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+// Everything due is taken off the heap before any callback runs, so a
+// callback re-arming itself in the past fires on the next pass, not in a loop
+auto EventLoop::expireTimers() -> void {
+    std::uint64_t expirations;
+    if (read(m_timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return; // re-armed by a callback earlier in this batch
+    }
+    m_timer_fd_deadline = Clock::time_point::max();
+
+    const auto now = Clock::now();
+    m_expired.clear();
+    while (!m_timer_heap.empty() && m_timer_heap.front().deadline <= now) {
+        std::pop_heap(m_timer_heap.begin(), m_timer_heap.end(), later);
+        if (isLive(m_timer_heap.back())) {
+            m_expired.push_back(m_timer_heap.back());
+        }
+        m_timer_heap.pop_back();
+    }
+    for (const auto& entry : m_expired) {
+        if (isLive(entry)) { // an earlier callback may have re-armed or disarmed it
+            ++m_timers[entry.timer].generation;
+            m_timers[entry.timer].callback();
+        }
+    }
+    scheduleTimerFd();
+}
+
+auto EventLoop::waitUntil(Clock::time_point deadline) -> void {
+    armTimer(m_tick_timer, deadline);
+    m_tick_expired = false;
+    m_interrupted = false;
+
+    std::array<epoll_event, 8> events;
+    while (!m_tick_expired && !m_interrupted) {
+        int ready = epoll_wait(m_epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("epoll_wait failed: " + std::string(strerror(errno)));
+        }
+        for (int i = 0; i < ready; ++i) {
+            dispatch(events[i].data.fd);
+        }
+        std::erase_if(m_handlers, [](const auto& handler) { return handler->fd == -1; });
+    }
+}
+
+auto EventLoop::dispatch(int fd) -> void {
+    auto it = std::find_if(m_handlers.begin(), m_handlers.end(), [fd](const auto& handler) {
+        return handler->fd == fd;
+    });
+    if (it == m_handlers.end()) return;
+    Handler* handler = it->get(); // stays valid even if the callback watches new fds
+    handler->callback();
+}
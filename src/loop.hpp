@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+// Single-threaded epoll reactor. The daemon blocks only in epoll_wait:
+// fds (Hyprland sockets), timers and signals (signalfd) all wake it.
+// Callbacks run on the caller's thread and must not wait on the loop themselves.
+// Timers share one timerfd, armed for the earliest deadline of a min-heap.
+class EventLoop {
+public:
+    using Callback = std::function<void()>;
+    using Clock = std::chrono::steady_clock; // CLOCK_MONOTONIC, same as timerfd
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    auto watch(int fd, Callback on_readable) -> void;
+    auto unwatch(int fd) -> void;  // does not close fd
+    auto watchSignals(std::initializer_list<int> signals, std::function<void(int)> on_signal) -> void;
+
+    // one-shot deadlines, re-arming replaces the pending deadline; no fd per timer
+    auto addTimer(Callback on_expire) -> int;
+    auto armTimer(int timer, Clock::time_point deadline) -> void;
+    auto disarmTimer(int timer) -> void;
+
+    // dispatch events until the deadline passes or a callback calls interrupt()
+    auto waitUntil(Clock::time_point deadline) -> void;
+    auto waitFor(std::chrono::milliseconds timeout) -> void { waitUntil(Clock::now() + timeout); }
+    auto interrupt() -> void { m_interrupted = true; }
+
+private:
+    struct Handler {
+        int fd;
+        Callback callback;
+    };
+
+    struct Timer {
+        Callback callback;
+        std::uint32_t generation = 0; // bumped by every arm/disarm, older heap entries are dead
+    };
+    struct TimerEntry {
+        Clock::time_point deadline;
+        int timer;
+        std::uint32_t generation;
+    };
+
+    // std heap functions build a max-heap, so "less" means later
+    static auto later(const TimerEntry& a, const TimerEntry& b) -> bool { return a.deadline > b.deadline; }
+
+    auto dispatch(int fd) -> void;
+    auto expireTimers() -> void;
+    auto scheduleTimerFd() -> void; // timerfd follows the heap top, set only when that changes
+    auto isLive(const TimerEntry& entry) const -> bool { return m_timers[entry.timer].generation == entry.generation; }
+
+    int m_epoll_fd = -1;
+    int m_timer_fd = -1;
+    Clock::time_point m_timer_fd_deadline = Clock::time_point::max(); // max when disarmed
+    std::deque<Timer> m_timers;              // indexed by timer id, stable while a callback adds one
+    std::vector<TimerEntry> m_timer_heap;    // earliest first, dead entries dropped lazily
+    std::vector<TimerEntry> m_expired;       // reused by expireTimers
+    int m_tick_timer = -1;
+    bool m_tick_expired = false;
+    bool m_interrupted = false;
+    // a handful of fds: linear lookup, stable addresses so callbacks may watch()
+    std::vector<std::unique_ptr<Handler>> m_handlers;
+    std::vector<int> m_owned_fds; // timerfd and signalfd, closed with the loop
+};
@@ -63,16 +63,29 @@ auto removePidFile() -> void {
 struct Args {
     std::string mode{};
     int threshold = Constants::DEFAULT_BAR_THRESHOLD;
+    int reload_window = static_cast<int>(Constants::RELOAD_COALESCE_WINDOW.count());
+    bool pool = false;
+    hypr_commands_t hypr_commands{};
+    bool standby = false;
+    bool predict = false;
+    std::string trace_path{};
     bool help = false;
     int verbose = 0;  // 0 = normal, 1 = -v (LOG), 2 = -vv (TRACE)
 };
 
 auto parseArguments(int argc, char* argv[]) -> Args {
-    const char *short_opts = "m:ht:v";
+    const char *short_opts = "m:ht:r:pH:S:wPT:v";
     const struct option long_opts[] = {
         {"mode", required_argument, nullptr, 'm'},
         {"help", no_argument, nullptr, 'h'},
         {"threshold", required_argument, nullptr, 't'},
+        {"reload-window", required_argument, nullptr, 'r'},
+        {"pool", no_argument, nullptr, 'p'},
+        {"hypr-hide", required_argument, nullptr, 'H'},
+        {"hypr-show", required_argument, nullptr, 'S'},
+        {"warm-standby", no_argument, nullptr, 'w'},
+        {"predict", no_argument, nullptr, 'P'},
+        {"record-trace", required_argument, nullptr, 'T'},
         {"verbose", no_argument, nullptr, 'v'},
         {nullptr, 0, nullptr, 0}
     };
@@ -104,6 +117,39 @@ auto parseArguments(int argc, char* argv[]) -> Args {
                 exit(1);
             }
             break;
+        case 'r':
+            try {
+                int window = std::stoi(std::string(optarg));
+                if (window < 0 || window > Constants::MAX_RELOAD_WINDOW) {
+                    log_message(CRIT, "Reload window must be between 0 and {} ms\n", Constants::MAX_RELOAD_WINDOW);
+                    printHelp();
+                    exit(1);
+                }
+                args.reload_window = window;
+            } catch (const std::exception&) {
+                log_message(CRIT, "Invalid reload window value: {}\n", optarg);
+                printHelp();
+                exit(1);
+            }
+            break;
+        case 'p':
+            args.pool = true;
+            break;
+        case 'H':
+            args.hypr_commands.hide = optarg;
+            break;
+        case 'S':
+            args.hypr_commands.show = optarg;
+            break;
+        case 'w':
+            args.standby = true;
+            break;
+        case 'P':
+            args.predict = true;
+            break;
+        case 'T':
+            args.trace_path = optarg;
+            break;
         case 'v':
             args.verbose++;
             break;
@@ -113,21 +159,13 @@ auto parseArguments(int argc, char* argv[]) -> Args {
         }
     }
 
-    return args;
-}
-
-// Global waybar instance for signal handling
-static Waybar* g_waybar_instance = nullptr;
-
-// External reference to interrupt flag
-extern std::atomic<bool> g_interrupt_request;
+    if (args.hypr_commands.hide.empty() != args.hypr_commands.show.empty()) {
+        log_message(CRIT, "--hypr-hide and --hypr-show must be given together\n");
+        printHelp();
+        exit(1);
+    }
 
-// Signal handler for cleanup
-auto cleanup_handler(int signal) -> void {
-    log_message(WARN, "Signal {} received, initiating graceful shutdown...\n", signal);
-    
-    // Set the interrupt flag to signal all main loops to exit
-    g_interrupt_request.store(true, std::memory_order_release);
+    return args;
 }
 
 auto main(int argc, char *argv[]) -> int {
@@ -143,16 +181,13 @@ auto main(int argc, char *argv[]) -> int {
         // Create PID file to prevent multiple instances
         createPidFile();
         
-        // Set up signal handlers for cleanup
-        std::signal(SIGINT, cleanup_handler);
-        std::signal(SIGTERM, cleanup_handler);
-        std::signal(SIGHUP, cleanup_handler);
-        
+        // SIGINT/SIGTERM/SIGHUP are read from a signalfd in Waybar's event loop
+
         // Ensure cleanup on exit
         std::atexit([]() { removePidFile(); });
         
-        Waybar bar(args.mode, args.threshold, args.verbose, config_dir);
-        g_waybar_instance = &bar;  // Set global pointer for signal handler
+        Waybar bar(args.mode, args.threshold, args.verbose, config_dir, std::chrono::milliseconds(args.reload_window), args.pool,
+                   args.hypr_commands, args.standby, args.predict, args.trace_path);
         bar.run();
         
         // Cleanup after main loop exits
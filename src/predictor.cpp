@@ -0,0 +1,39 @@
+#include "predictor.hpp"
+
+namespace {
+// a sampler that backed off this far has no useful velocity left
+constexpr auto STALE_AFTER = std::chrono::milliseconds(1000);
+}
+
+auto RevealPredictor::update(Clock::time_point at, int monitor, int distance) -> bool {
+    if (!m_primed || monitor != m_monitor || at - m_at > STALE_AFTER) {
+        m_primed = monitor >= 0;
+        m_monitor = monitor;
+        m_at = at;
+        m_position = distance;
+        m_velocity = 0;
+        m_braking = 0;
+        m_streak = 0;
+        return false;
+    }
+    const double dt = std::chrono::duration<double, std::milli>(at - m_at).count();
+    if (dt <= 0) {
+        return false;
+    }
+    m_at = at;
+
+    const double predicted = m_position + m_velocity * dt;
+    const double residual = distance - predicted;
+    const double velocity = m_velocity;
+    m_position = predicted + m_config.alpha * residual;
+    m_velocity += m_config.beta * residual / dt;
+    m_braking += m_config.beta * ((m_velocity - velocity) / dt - m_braking);
+
+    // in the zone the state machine takes over; a prediction only ever runs ahead of it
+    const bool heading_in = distance > 0 && distance <= m_config.max_distance && m_velocity <= -m_config.min_speed &&
+                            m_position / -m_velocity <= static_cast<double>(m_config.horizon.count()) &&
+                            m_braking <= m_config.max_braking;
+    m_streak = heading_in ? m_streak + 1 : 0;
+    return m_streak >= m_config.confirm;
+}
+
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+
+struct reveal_predictor_config_t {
+    double alpha = 0.8;                            // position gain
+    double beta = 0.3;                             // velocity gain
+    std::chrono::milliseconds horizon{100};        // reveal when the zone is at most this far ahead
+    double min_speed = 1.0;                        // px/ms toward the edge, slower is not heading there
+    int max_distance = 300;                        // px, farther away nothing is predicted
+    double max_braking = 0;                        // px/ms², a hand that slows down is aiming below the edge
+    int confirm = 3;                               // consecutive samples that must agree
+    std::chrono::milliseconds hold{400};           // a reveal the cursor does not follow into the zone hides after this
+};
+
+// Alpha-beta filter over the cursor's distance to the activation zone of
+// its monitor, one sample at a time with whatever spacing the sampler used.
+// It calls a reveal when the filtered speed would reach the zone within the
+// horizon on several samples in a row without slowing down. Nobody aims at
+// a screen edge, the pointer just runs into it, so a hand that brakes is
+// going for something below it; a cursor sliding along the edge has no
+// speed toward it at all.
+class RevealPredictor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RevealPredictor(reveal_predictor_config_t config = {}) : m_config(config) {}
+
+    // distance in px above the zone, 0 inside it; a new monitor starts over
+    auto update(Clock::time_point at, int monitor, int distance) -> bool;
+    auto velocity() const -> double { return m_velocity; } // px/ms, negative toward the edge
+    auto config() const -> const reveal_predictor_config_t& { return m_config; }
+
+private:
+    reveal_predictor_config_t m_config;
+    bool m_primed = false;
+    int m_monitor = -1;
+    Clock::time_point m_at{};
+    double m_position = 0;
+    double m_velocity = 0;
+    double m_braking = 0; // px/ms², positive while slowing down toward the edge
+    int m_streak = 0;
+};
@@ -0,0 +1,138 @@
+#include "sampler.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+auto notify(int fd) -> void {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] auto written = write(fd, &one, sizeof(one));
+}
+
+auto consume(int fd) -> void {
+    std::uint64_t count;
+    [[maybe_unused]] auto n = read(fd, &count, sizeof(count));
+}
+}
+
+CursorSampler::CursorSampler(Take take) : m_take(std::move(take)) {
+    m_ready_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_ready_fd == -1 || m_wake_fd == -1 || m_timer_fd == -1) {
+        std::string error = strerror(errno);
+        for (int fd : {m_ready_fd, m_wake_fd, m_timer_fd}) {
+            if (fd != -1) close(fd);
+        }
+        throw std::runtime_error("Failed to create the cursor sampler: " + error);
+    }
+}
+
+CursorSampler::~CursorSampler() {
+    stop();
+    close(m_ready_fd);
+    close(m_wake_fd);
+    close(m_timer_fd);
+}
+
+// The thread inherits the signal mask of the loop's thread, so SIGINT and
+// friends keep going to the signalfd
+auto CursorSampler::start(std::chrono::nanoseconds interval) -> void {
+    if (m_thread.joinable()) {
+        return;
+    }
+    cursor_sample_t stale;
+    while (m_ring.pop(stale)) {}
+    m_interval_ns.store(interval.count(), std::memory_order_relaxed);
+    m_stop.store(false, std::memory_order_relaxed);
+    m_thread = std::thread([this] { run(); });
+}
+
+auto CursorSampler::stop() -> void {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    m_stop.store(true, std::memory_order_release);
+    notify(m_wake_fd);
+    m_thread.join();
+}
+
+auto CursorSampler::acknowledge() -> void {
+    if (m_ready_signalled.exchange(false, std::memory_order_seq_cst)) {
+        consume(m_ready_fd);
+    }
+}
+
+auto CursorSampler::setInterval(std::chrono::nanoseconds interval) -> void {
+    const auto previous = m_interval_ns.exchange(interval.count(), std::memory_order_relaxed);
+    if (interval.count() < previous) {
+        notify(m_wake_fd);
+    }
+}
+
+auto CursorSampler::sampleNow() -> void {
+    m_sample_now.store(true, std::memory_order_release);
+    notify(m_wake_fd);
+}
+
+auto CursorSampler::arm(std::chrono::steady_clock::time_point deadline) -> void {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    itimerspec spec{};
+    spec.it_value.tv_sec = ns / 1'000'000'000;
+    spec.it_value.tv_nsec = ns % 1'000'000'000;
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1; // all zero would disarm
+    }
+    timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+// Deadlines advance from the previous due time, not from when the sample
+// finished; slots missed behind a slow IPC round trip are skipped, not
+// bunched up
+auto CursorSampler::run() -> void {
+    using clock = std::chrono::steady_clock;
+    auto interval = [this] { return std::chrono::nanoseconds(m_interval_ns.load(std::memory_order_relaxed)); };
+    auto due = clock::now();
+    auto last_due = due - interval();
+    std::array<pollfd, 2> fds{{{m_timer_fd, POLLIN, 0}, {m_wake_fd, POLLIN, 0}}};
+
+    while (!m_stop.load(std::memory_order_acquire)) {
+        auto now = clock::now();
+        if (now < due) {
+            arm(due);
+            if (poll(fds.data(), fds.size(), -1) == -1 && errno != EINTR) {
+                break;
+            }
+            if (fds[0].revents & POLLIN) consume(m_timer_fd);
+            if (fds[1].revents & POLLIN) {
+                consume(m_wake_fd);
+                due = m_sample_now.exchange(false, std::memory_order_acquire) ? clock::now() : last_due + interval();
+            }
+            continue;
+        }
+
+        cursor_sample_t sample{.snap = m_take(), .due = due};
+        if (!m_ring.push(sample)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        // seq_cst against acknowledge(): either the consumer sees this sample, or we see its reset
+        if (!m_ready_signalled.exchange(true, std::memory_order_seq_cst)) {
+            notify(m_ready_fd);
+        }
+
+        last_due = due;
+        now = clock::now();
+        const auto step = std::max(interval(), std::chrono::nanoseconds(1));
+        due += step;
+        if (due <= now) {
+            due += step * ((now - due) / step + 1);
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <thread>
+
+// Compositor state for one tick, fetched with a single [[BATCH]] request so
+// every decision in the tick sees the same cursor, workspace and monitor
+struct HyprSnapshot {
+    int cursor_x = -1, cursor_y = -1;
+    int workspace = 1;
+    std::chrono::steady_clock::time_point taken_at{};
+    std::array<char, 32> monitor{};  // active monitor name, NUL terminated
+
+    auto monitorName() const -> std::string_view { return monitor.data(); }
+};
+
+// A snapshot and the point of the schedule it was taken for
+struct cursor_sample_t {
+    HyprSnapshot snap{};
+    std::chrono::steady_clock::time_point due{};
+};
+
+// Wait-free single-producer single-consumer ring; each side owns one index
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    auto push(const T& value) -> bool { // producer only, false when full
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        m_items[tail & (N - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto pop(T& value) -> bool { // consumer only, false when empty
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_items[head & (N - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, N> m_items{};
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+// Takes cursor samples on its own thread, on an absolute CLOCK_MONOTONIC
+// schedule (a timerfd armed with TFD_TIMER_ABSTIME), so the IPC round trip
+// and whatever the event loop is doing never shift the next sample. Samples
+// go through the ring; fd() wakes the consumer once per batch.
+class CursorSampler {
+public:
+    using Take = std::function<HyprSnapshot()>; // runs on the sampler thread
+
+    explicit CursorSampler(Take take);
+    ~CursorSampler();
+    CursorSampler(const CursorSampler&) = delete;
+    CursorSampler& operator=(const CursorSampler&) = delete;
+
+    auto start(std::chrono::nanoseconds interval) -> void; // first sample right away
+    auto stop() -> void;
+    auto fd() const -> int { return m_ready_fd; }
+    auto acknowledge() -> void;                      // consumer: clears fd() before popping
+    auto pop(cursor_sample_t& sample) -> bool { return m_ring.pop(sample); }
+    auto setInterval(std::chrono::nanoseconds interval) -> void; // from the last due time; a shorter one reschedules at once
+    auto sampleNow() -> void;                        // an event wants a fresh sample
+    auto dropped() const -> int { return m_dropped.load(std::memory_order_relaxed); } // ring was full
+
+private:
+    auto run() -> void;
+    auto arm(std::chrono::steady_clock::time_point deadline) -> void;
+
+    Take m_take;
+    SpscRing<cursor_sample_t, 64> m_ring;
+    std::thread m_thread;
+    int m_ready_fd = -1;  // eventfd, sampler -> loop
+    int m_wake_fd = -1;   // eventfd, loop -> sampler
+    int m_timer_fd = -1;  // the schedule, only touched by the sampler thread
+    std::atomic<long long> m_interval_ns{0};
+    std::atomic<bool> m_ready_signalled{false};
+    std::atomic<bool> m_sample_now{false};
+    std::atomic<bool> m_stop{false};
+    std::atomic<int> m_dropped{0};
+};
@@ -0,0 +1,390 @@
+#include "supervisor.hpp"
+#include "waybar.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+
+WaybarSupervisor::WaybarSupervisor(EventLoop& loop, supervisor_hooks_t hooks)
+    : m_loop(loop), m_hooks(std::move(hooks)) {
+    m_timer = m_loop.addTimer([this] { handleTimer(); });
+}
+
+WaybarSupervisor::~WaybarSupervisor() {
+    for (const auto& bar : m_instances) {
+        if (bar.pidfd != -1) close(bar.pidfd);
+        if (bar.standby.pidfd != -1) close(bar.standby.pidfd);
+    }
+    for (const auto& stopping : m_stopping) {
+        close(stopping.pidfd);
+    }
+}
+
+auto WaybarSupervisor::add(std::string output, std::string config) -> size_t {
+    m_instances.push_back({.id = m_next_id++, .output = std::move(output), .config = std::move(config)});
+    spawn(m_instances.size() - 1);
+    return m_instances.size() - 1;
+}
+
+auto WaybarSupervisor::indexOf(std::uint32_t id) const -> size_t {
+    auto it = std::find_if(m_instances.cbegin(), m_instances.cend(), [id](const waybar_instance_t& bar) {
+        return bar.id == id;
+    });
+    return static_cast<size_t>(it - m_instances.cbegin());
+}
+
+// Called from the loop (a monitor went away), so nothing here waits for
+// the process; the pidfd stays watched and handleExit reaps it
+auto WaybarSupervisor::remove(size_t index) -> void {
+    auto& bar = m_instances[index];
+    retire(bar.pid, bar.pidfd);
+    retire(bar.standby.pid, bar.standby.pidfd);
+    m_instances.erase(m_instances.begin() + static_cast<std::ptrdiff_t>(index));
+    armTimer();
+}
+
+auto WaybarSupervisor::retire(pid_t pid, int& pidfd) -> void {
+    if (pidfd == -1) {
+        return;
+    }
+    log_message(INFO, "Shutting down waybar process (PID: {})\n", pid);
+    if (signal_pidfd(pidfd, SIGTERM) == -1 && errno != ESRCH) {
+        log_message(WARN, "Failed to send SIGTERM to waybar process {}: {}\n", pid, strerror(errno));
+    }
+    m_stopping.push_back({.pid = pid, .pidfd = std::exchange(pidfd, -1),
+                          .kill_at = std::chrono::steady_clock::now() + Constants::WAYBAR_STOP_TIMEOUT});
+}
+
+// On the way out the loop no longer runs, so this one waits
+auto WaybarSupervisor::stopAll() -> void {
+    for (size_t i = 0; i < m_instances.size(); ++i) {
+        stop(i);
+    }
+    for (auto& stopping : m_stopping) {
+        m_loop.unwatch(stopping.pidfd);
+        if (!wait_for_exit(stopping.pidfd, Constants::WAYBAR_STOP_TIMEOUT)) {
+            signal_pidfd(stopping.pidfd, SIGKILL);
+            wait_for_exit(stopping.pidfd, Constants::WAYBAR_STOP_TIMEOUT);
+        }
+        waitpid(stopping.pid, nullptr, WNOHANG);
+        close(stopping.pidfd);
+    }
+    m_stopping.clear();
+    armTimer();
+}
+
+// Signals go through the pidfd, so they can never reach a recycled pid. A
+// dead waybar is not restarted here: its pidfd is already readable and
+// handleExit takes it from there.
+auto WaybarSupervisor::signal(size_t index, int signal) -> bool {
+    const auto& bar = m_instances[index];
+    if (bar.phase != WaybarPhase::Running) {
+        return false;
+    }
+    if (signal_pidfd(bar.pidfd, signal) == 0) {
+        return true;
+    }
+    if (errno != ESRCH) {
+        log_message(WARN, "Failed to send signal {} to waybar process {}: {}\n", signal, bar.pid, strerror(errno));
+    }
+    return false;
+}
+
+auto WaybarSupervisor::startProcess(const std::string& config, pid_t& pid, int& pidfd) -> std::string {
+    const char* const plain_argv[] = {"waybar", nullptr};
+    const char* const config_argv[] = {"waybar", "-c", config.c_str(), nullptr};
+    pid = spawn_process(config.empty() ? plain_argv : config_argv);
+    if (pid <= 0) {
+        return fmt::format("failed to spawn: {}", strerror(errno));
+    }
+    pidfd = open_pidfd(pid);
+    if (pidfd == -1) {
+        std::string error = strerror(errno);
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return "cannot watch it: " + error;
+    }
+    const pid_t child = pid;
+    m_loop.watch(pidfd, [this, child] { handleExit(child); });
+    return {};
+}
+
+// per-monitor modes run waybar on the variant link, so a restarted waybar
+// comes back with the current visibility; pool instances on their own output
+auto WaybarSupervisor::spawn(size_t index) -> void {
+    auto& bar = m_instances[index];
+    if (m_hooks.environment_ready && !m_hooks.environment_ready()) {
+        fail(index, "cannot start, environment not ready");
+        return;
+    }
+    log(INFO, fmt::format("Starting waybar{}...\n", bar.output.empty() ? "" : " for " + bar.output));
+
+    pid_t pid = -1;
+    int pidfd = -1;
+    if (auto error = startProcess(bar.config, pid, pidfd); !error.empty()) {
+        fail(index, error);
+        return;
+    }
+    bar.pid = pid;
+    bar.pidfd = pidfd;
+    bar.phase = WaybarPhase::Starting;
+    bar.visible = true;
+    bar.stale = false;
+    bar.deadline = std::chrono::steady_clock::now() + Constants::WAYBAR_STARTUP_GRACE;
+    armTimer();
+}
+
+// The standby reads a config that starts its bars hidden, so it never
+// shows up next to the active waybar or takes screen space
+auto WaybarSupervisor::spawnStandby(size_t index) -> void {
+    auto& standby = m_instances[index].standby;
+    if (!m_standby || standby.phase == WaybarPhase::Starting || standby.phase == WaybarPhase::Running) {
+        return;
+    }
+    try {
+        standby.config = m_hooks.prepare_standby(index);
+    } catch (const std::exception& e) {
+        failStandby(index, e.what());
+        return;
+    }
+    if (auto error = startProcess(standby.config, standby.pid, standby.pidfd); !error.empty()) {
+        failStandby(index, error);
+        return;
+    }
+    standby.phase = WaybarPhase::Starting;
+    standby.deadline = std::chrono::steady_clock::now() + Constants::WAYBAR_STARTUP_GRACE;
+    armTimer();
+}
+
+// Exponential, with +-25% jitter so pool instances that died together do
+// not all come back in the same instant
+auto WaybarSupervisor::backoff(int failures) -> std::chrono::milliseconds {
+    auto delay = Constants::WAYBAR_RESTART_BACKOFF_MIN * (1LL << std::min(failures, 16));
+    delay = std::min<std::chrono::milliseconds>(delay, Constants::WAYBAR_RESTART_BACKOFF_MAX);
+    std::uniform_real_distribution<double> jitter(0.75, 1.25);
+    return std::chrono::milliseconds(static_cast<long long>(static_cast<double>(delay.count()) * jitter(m_rng)));
+}
+
+auto WaybarSupervisor::fail(size_t index, std::string_view reason) -> void {
+    auto& bar = m_instances[index];
+    const auto delay = backoff(bar.failures++);
+    bar.phase = WaybarPhase::Down;
+    bar.deadline = std::chrono::steady_clock::now() + delay;
+    ++m_restarts;
+    log(WARN, fmt::format("Waybar{} {}, restarting in {}ms (attempt {})\n",
+                          bar.output.empty() ? "" : " for " + bar.output, reason, delay.count(), bar.failures));
+    armTimer();
+}
+
+auto WaybarSupervisor::failStandby(size_t index, std::string_view reason) -> void {
+    auto& standby = m_instances[index].standby;
+    const auto delay = backoff(standby.failures++);
+    standby.phase = WaybarPhase::Down;
+    standby.deadline = std::chrono::steady_clock::now() + delay;
+    log(WARN, fmt::format("Standby waybar {}, retrying in {}ms\n", reason, delay.count()));
+    armTimer();
+}
+
+// The standby is already up and hidden: it becomes the instance at once,
+// on_promote points its config at the real one and on_up shows it if needed.
+// The replacement standby starts in the background.
+auto WaybarSupervisor::promote(size_t index) -> void {
+    auto& bar = m_instances[index];
+    auto& standby = bar.standby;
+    bar.pid = std::exchange(standby.pid, -1);
+    bar.pidfd = std::exchange(standby.pidfd, -1);
+    bar.config = standby.config;
+    bar.phase = WaybarPhase::Running;
+    bar.up_since = std::chrono::steady_clock::now();
+    bar.visible = false;
+    bar.stale = true; // it read the hidden config, showing it must reload
+    standby.phase = WaybarPhase::Down;
+    if (m_hooks.on_promote) m_hooks.on_promote(index);
+    if (m_hooks.on_up) m_hooks.on_up(index);
+
+    const auto took = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bar.down_since);
+    ++m_stats.takeovers;
+    m_stats.takeover_total += took;
+    m_stats.takeover_max = std::max(m_stats.takeover_max, took);
+    bar.down_since = {};
+    log(INFO, fmt::format("Standby waybar {} took over in {}us\n", bar.pid, took.count()));
+    spawnStandby(index);
+}
+
+auto WaybarSupervisor::handleExit(pid_t pid) -> void {
+    auto stopped = std::find_if(m_stopping.begin(), m_stopping.end(), [pid](const waybar_stopping_t& stopping) {
+        return stopping.pid == pid;
+    });
+    if (stopped != m_stopping.end()) {
+        waitpid(pid, nullptr, WNOHANG);
+        m_loop.unwatch(stopped->pidfd);
+        close(stopped->pidfd);
+        m_stopping.erase(stopped);
+        armTimer();
+        return;
+    }
+
+    auto it = std::find_if(m_instances.begin(), m_instances.end(), [pid](const waybar_instance_t& bar) {
+        return (bar.pid == pid && bar.pidfd != -1) || (bar.standby.pid == pid && bar.standby.pidfd != -1);
+    });
+    if (it == m_instances.end()) {
+        return;
+    }
+    auto& bar = *it;
+    const auto index = static_cast<size_t>(it - m_instances.begin());
+    const bool is_standby = bar.standby.pid == pid;
+    int& pidfd = is_standby ? bar.standby.pidfd : bar.pidfd;
+
+    int status = 0;
+    waitpid(pid, &status, WNOHANG);
+    int code = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+    m_loop.unwatch(pidfd);
+    close(pidfd);
+    pidfd = -1;
+    if (is_standby) {
+        bar.standby.pid = -1;
+        failStandby(index, fmt::format("process {} exited with status {}", pid, code));
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (bar.down_since == std::chrono::steady_clock::time_point{}) {
+        bar.down_since = now;
+    }
+    if (bar.phase == WaybarPhase::Running && now - bar.up_since >= Constants::WAYBAR_STABLE_AFTER) {
+        bar.failures = 0; // an isolated crash, not a crash loop
+    }
+    if (bar.standby.phase == WaybarPhase::Running) {
+        log(WARN, fmt::format("Waybar process {} exited with status {}, promoting the standby\n", pid, code));
+        ++bar.failures;
+        promote(index);
+        return;
+    }
+    const bool starting = bar.phase == WaybarPhase::Starting;
+    fail(index, fmt::format("process {} exited with status {}{}", pid, code, starting ? " during startup" : ""));
+}
+
+auto WaybarSupervisor::handleTimer() -> void {
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < m_instances.size(); ++i) {
+        auto& bar = m_instances[i];
+        if (bar.deadline <= now && bar.phase == WaybarPhase::Starting) {
+            bar.phase = WaybarPhase::Running;
+            bar.up_since = now;
+            log(INFO, fmt::format("Waybar started successfully with PID: {}\n", bar.pid));
+            if (bar.down_since != std::chrono::steady_clock::time_point{}) {
+                const auto took = std::chrono::duration_cast<std::chrono::microseconds>(now - bar.down_since);
+                ++m_stats.restarts;
+                m_stats.restart_total += took;
+                m_stats.restart_max = std::max(m_stats.restart_max, took);
+                bar.down_since = {};
+                log(INFO, fmt::format("Waybar recovered by a restart in {}ms\n", took.count() / 1000));
+            }
+            if (m_hooks.on_up) m_hooks.on_up(i);
+            spawnStandby(i); // only once the active one is up, they would compete for the CPU
+        } else if (bar.deadline <= now && bar.phase == WaybarPhase::Down) {
+            spawn(i);
+        }
+
+        auto& standby = bar.standby;
+        if (standby.deadline <= now && standby.phase == WaybarPhase::Starting) {
+            standby.phase = WaybarPhase::Running;
+            standby.failures = 0;
+            m_stats.standby_rss_kb = process_memory_kb(standby.pid, "VmRSS");
+            m_stats.standby_anon_kb = process_memory_kb(standby.pid, "RssAnon");
+            log(INFO, fmt::format("Standby waybar {} ready (VmRSS {} kB, RssAnon {} kB)\n",
+                                  standby.pid, m_stats.standby_rss_kb, m_stats.standby_anon_kb));
+            if (bar.phase == WaybarPhase::Down) {
+                promote(i); // beats waiting out the backoff
+            }
+        } else if (standby.deadline <= now && standby.phase == WaybarPhase::Down && m_standby &&
+                   bar.phase == WaybarPhase::Running) {
+            spawnStandby(i);
+        }
+    }
+    for (auto& stopping : m_stopping) {
+        if (!stopping.killed && stopping.kill_at <= now) {
+            log_message(WARN, "Force killing waybar process {}\n", stopping.pid);
+            signal_pidfd(stopping.pidfd, SIGKILL);
+            stopping.killed = true; // reaped by handleExit
+        }
+    }
+    armTimer();
+}
+
+auto WaybarSupervisor::armTimer() -> void {
+    auto next = std::chrono::steady_clock::time_point::max();
+    auto pending = [](WaybarPhase phase) { return phase == WaybarPhase::Down || phase == WaybarPhase::Starting; };
+    for (const auto& bar : m_instances) {
+        if (pending(bar.phase)) {
+            next = std::min(next, bar.deadline);
+        }
+        // a standby is only respawned next to a running waybar
+        const auto standby = bar.standby.phase;
+        if (m_standby && (standby == WaybarPhase::Starting || (standby == WaybarPhase::Down && bar.phase == WaybarPhase::Running))) {
+            next = std::min(next, bar.standby.deadline);
+        }
+    }
+    for (const auto& stopping : m_stopping) {
+        if (!stopping.killed) {
+            next = std::min(next, stopping.kill_at);
+        }
+    }
+    if (next == std::chrono::steady_clock::time_point::max()) {
+        m_loop.disarmTimer(m_timer);
+    } else {
+        m_loop.armTimer(m_timer, next);
+    }
+}
+
+auto WaybarSupervisor::stop(size_t index) -> void {
+    auto& bar = m_instances[index];
+    auto terminate = [this](pid_t pid, int& pidfd) {
+        if (pidfd == -1) {
+            return;
+        }
+        log_message(INFO, "Shutting down waybar process (PID: {})\n", pid);
+
+        // Returns as soon as waybar exits instead of polling kill(pid, 0)
+        m_loop.unwatch(pidfd);
+        if (signal_pidfd(pidfd, SIGTERM) == -1) {
+            if (errno != ESRCH) {
+                log_message(WARN, "Failed to send SIGTERM to waybar process {}: {}\n", pid, strerror(errno));
+            }
+        } else if (!wait_for_exit(pidfd, Constants::WAYBAR_STOP_TIMEOUT)) {
+            log_message(WARN, "Force killing waybar process {}\n", pid);
+            signal_pidfd(pidfd, SIGKILL);
+            wait_for_exit(pidfd, Constants::WAYBAR_STOP_TIMEOUT);
+        }
+        waitpid(pid, nullptr, WNOHANG);
+        close(pidfd);
+        pidfd = -1;
+    };
+    bar.phase = WaybarPhase::Stopped;
+    bar.standby.phase = WaybarPhase::Stopped;
+    terminate(bar.pid, bar.pidfd);
+    terminate(bar.standby.pid, bar.standby.pidfd);
+}
+
+auto WaybarSupervisor::logStats() const -> void {
+    const auto& stats = m_stats;
+    if (stats.takeovers == 0 && stats.restarts == 0 && stats.standby_rss_kb < 0) {
+        return;
+    }
+    auto avg = [](std::chrono::microseconds total, int count) { return count > 0 ? total.count() / count : 0; };
+    log_message(LOG, "Recovery: {} standby takeovers (avg {}us, max {}us), {} restarts (avg {}ms, max {}ms)\n",
+               stats.takeovers, avg(stats.takeover_total, stats.takeovers), stats.takeover_max.count(),
+               stats.restarts, avg(stats.restart_total, stats.restarts) / 1000, stats.restart_max.count() / 1000);
+    if (stats.standby_rss_kb >= 0) {
+        log_message(LOG, "Standby cost: VmRSS {} kB, RssAnon {} kB per standby waybar\n",
+                   stats.standby_rss_kb, stats.standby_anon_kb);
+    }
+}
+
+auto WaybarSupervisor::log(LogLevel level, const std::string& message) -> void {
+    if (m_hooks.log_to_file) m_hooks.log_to_file(message);
+    log_message(level, "{}", message);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "loop.hpp"
+#include "utils.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+// Lifecycle of one waybar process
+enum class WaybarPhase : std::uint8_t {
+    Down,     // waiting out the restart backoff
+    Starting, // spawned, inside the startup grace; a signal now could kill it
+    Running,
+    Stopped   // stopped on purpose, never restarted
+};
+
+// --warm-standby: a second waybar per instance, started hidden, that takes
+// over the moment the active one dies
+struct waybar_standby_t {
+    std::string config{};  // -c argument, a link retargeted on promotion
+    pid_t pid = -1;
+    int pidfd = -1;
+    WaybarPhase phase = WaybarPhase::Down;
+    int failures = 0;
+    std::chrono::steady_clock::time_point deadline{};
+};
+
+// One waybar process. Without --pool a single instance runs on the variant
+// link; with it, every monitor gets one on a config listing only that output.
+struct waybar_instance_t {
+    std::uint32_t id = 0;  // never reused, unlike the index while the pool changes
+    std::string output{};  // empty for the shared instance
+    std::string config{};  // -c argument, empty for waybar's own lookup
+    pid_t pid = -1;
+    int pidfd = -1;        // watched by the loop, readable once this waybar exits
+    WaybarPhase phase = WaybarPhase::Down;
+    bool visible = true;   // waybar starts visible, SIGUSR1 toggles
+    bool stale = false;    // config rewritten while hidden, showing it reloads instead
+    int failures = 0;      // consecutive, forgotten once it stays up
+    std::chrono::steady_clock::time_point deadline{}; // restart, or end of the startup grace
+    std::chrono::steady_clock::time_point up_since{};
+    std::chrono::steady_clock::time_point down_since{}; // last exit, for the recovery latency
+    waybar_standby_t standby{};
+};
+
+struct supervisor_hooks_t {
+    std::function<bool()> environment_ready;        // cheap probe, no waiting
+    std::function<void(size_t index)> on_up;        // survived the startup grace, or a standby took over
+    std::function<void(const std::string&)> log_to_file;
+    std::function<std::string(size_t index)> prepare_standby; // -c for a new standby, a config that starts hidden
+    std::function<void(size_t index)> on_promote;   // the standby's -c has to become the instance's config
+};
+
+// A removed waybar on its way out: SIGTERM sent, SIGKILL at kill_at, reaped
+// from the loop once its pidfd turns readable
+struct waybar_stopping_t {
+    pid_t pid = -1;
+    int pidfd = -1;
+    std::chrono::steady_clock::time_point kill_at{};
+    bool killed = false;
+};
+
+// Time from noticing an exit to a waybar being back in charge, reported with -v
+struct recovery_stats_t {
+    int takeovers = 0;  // standby promoted
+    std::chrono::microseconds takeover_total{}, takeover_max{};
+    int restarts = 0;   // cold: backoff + spawn + startup grace
+    std::chrono::microseconds restart_total{}, restart_max{};
+    long standby_rss_kb = -1;  // last standby's VmRSS / RssAnon once it was up
+    long standby_anon_kb = -1;
+};
+
+// Keeps the waybar instances alive without ever blocking the event loop.
+// Spawning returns at once; the startup grace, exits and restarts are all
+// loop events. A waybar that keeps dying is restarted with exponential
+// backoff and jitter instead of taking the daemon down. Callers treat an
+// instance that is not Running as unreachable (signal() returns false) and
+// re-apply what they want from on_up.
+class WaybarSupervisor {
+public:
+    WaybarSupervisor(EventLoop& loop, supervisor_hooks_t hooks);
+    ~WaybarSupervisor(); // closes the pidfds, stopping is up to stopAll()
+    WaybarSupervisor(const WaybarSupervisor&) = delete;
+    WaybarSupervisor& operator=(const WaybarSupervisor&) = delete;
+
+    auto enableStandby() -> void { m_standby = true; } // before the first add()
+    auto add(std::string output, std::string config) -> size_t; // spawns right away
+    auto remove(size_t index) -> void;                           // stops it for good, in the background
+    auto stopAll() -> void;                                      // SIGTERM, SIGKILL after the timeout, waits
+    auto signal(size_t index, int signal) -> bool;               // false unless Running
+    auto indexOf(std::uint32_t id) const -> size_t;              // size() once it was removed
+    auto restarts() const -> int { return m_restarts; }
+    auto logStats() const -> void;
+
+    auto size() const -> size_t { return m_instances.size(); }
+    auto empty() const -> bool { return m_instances.empty(); }
+    auto operator[](size_t index) -> waybar_instance_t& { return m_instances[index]; }
+    auto operator[](size_t index) const -> const waybar_instance_t& { return m_instances[index]; }
+    auto begin() const { return m_instances.cbegin(); }
+    auto end() const { return m_instances.cend(); }
+
+private:
+    auto spawn(size_t index) -> void;
+    auto spawnStandby(size_t index) -> void;
+    auto startProcess(const std::string& config, pid_t& pid, int& pidfd) -> std::string; // error text, empty on success
+    auto fail(size_t index, std::string_view reason) -> void; // schedules the restart
+    auto failStandby(size_t index, std::string_view reason) -> void;
+    auto promote(size_t index) -> void;
+    auto stop(size_t index) -> void;
+    auto retire(pid_t pid, int& pidfd) -> void; // SIGTERM now, the loop does the rest
+    auto handleExit(pid_t pid) -> void;
+    auto handleTimer() -> void;
+    auto armTimer() -> void;  // earliest pending deadline, one timerfd for all instances
+    auto backoff(int failures) -> std::chrono::milliseconds;
+    auto log(LogLevel level, const std::string& message) -> void; // console and log file
+
+    EventLoop& m_loop;
+    supervisor_hooks_t m_hooks;
+    int m_timer = -1;
+    bool m_standby = false;
+    std::vector<waybar_instance_t> m_instances;
+    std::vector<waybar_stopping_t> m_stopping;
+    std::mt19937 m_rng{std::random_device{}()};
+    int m_restarts = 0;
+    std::uint32_t m_next_id = 0;
+    recovery_stats_t m_stats{};
+};
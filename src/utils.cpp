@@ -5,83 +5,455 @@
 #include <string>
 #include <unistd.h>
 #include <cstdio>
-#include <sstream>
+#include <cstdlib>
 #include <vector>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <charconv>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <thread>
 
-// Get process arguments by PID
-auto get_process_args(const pid_t pid) -> std::string {
-    std::string proc_path = "/proc/" + std::to_string(pid) + "/cmdline";
-    std::ifstream file(proc_path);
-    if (!file.is_open()) {
+namespace {
+
+// "/proc/<pid>/<file>" into buf, no allocation
+auto proc_path(std::array<char, 64>& buf, pid_t pid, std::string_view file) -> const char* {
+    constexpr std::string_view prefix = "/proc/";
+    char* out = std::copy(prefix.begin(), prefix.end(), buf.data());
+    out = std::to_chars(out, buf.data() + buf.size(), pid).ptr;
+    *out++ = '/';
+    out = std::copy(file.begin(), file.end(), out);
+    *out = '\0';
+    return buf.data();
+}
+
+// Same rule as pidof: comm (cut to 15 chars by the kernel), and the exe
+// basename for names too long for comm. stat carries comm and the state in
+// one read, so exited-but-unreaped zombies are skipped too.
+auto process_matches(pid_t pid, std::string_view name) -> bool {
+    constexpr size_t COMM_LENGTH = 15;
+    std::array<char, 64> path;
+    std::array<char, 256> buf;
+
+    int fd = open(proc_path(path, pid, "stat"), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    ssize_t len = read(fd, buf.data(), buf.size());
+    close(fd);
+    if (len <= 0) return false;
+
+    // "pid (comm) S ...", comm itself may contain ')'
+    std::string_view stat(buf.data(), static_cast<size_t>(len));
+    auto open_paren = stat.find('(');
+    auto close_paren = stat.rfind(')');
+    if (open_paren == std::string_view::npos || close_paren == std::string_view::npos ||
+        close_paren + 2 >= stat.size()) return false;
+    std::string_view comm = stat.substr(open_paren + 1, close_paren - open_paren - 1);
+    if (stat[close_paren + 2] == 'Z') return false;
+    if (comm != name.substr(0, COMM_LENGTH)) return false;
+    if (name.size() <= COMM_LENGTH) return true;
+
+    len = readlink(proc_path(path, pid, "exe"), buf.data(), buf.size());
+    if (len <= 0) return false;
+    std::string_view exe(buf.data(), static_cast<size_t>(len));
+    return exe.substr(exe.rfind('/') + 1) == name;
+}
+
+} // namespace
+
+// Walks /proc with getdents64 instead of exec'ing pidof
+auto find_processes(std::string_view name, process_list_t& found) -> size_t {
+    found.count = 0;
+    int dir = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir == -1) return 0;
+
+    // dirent64 matches the kernel's linux_dirent64 record layout
+    alignas(dirent64) std::array<char, 8192> buf;
+    long len;
+    while ((len = syscall(SYS_getdents64, dir, buf.data(), buf.size())) > 0) {
+        for (long off = 0; off < len; ) {
+            auto* entry = reinterpret_cast<const dirent64*>(buf.data() + off);
+            off += entry->d_reclen;
+            if (entry->d_type != DT_DIR) continue;
+
+            std::string_view entry_name(entry->d_name);
+            pid_t pid = 0;
+            auto [end, ec] = std::from_chars(entry_name.data(), entry_name.data() + entry_name.size(), pid);
+            if (ec != std::errc{} || end != entry_name.data() + entry_name.size()) continue;
+
+            if (process_matches(pid, name) && found.count < found.pids.size()) {
+                found.pids[found.count++] = pid;
+            }
+        }
+    }
+    close(dir);
+    return found.count;
+}
+
+// Drops pids that exited or now belong to another program; a few reads
+// per pid instead of a full /proc walk
+auto revalidate_processes(std::string_view name, process_list_t& known) -> size_t {
+    auto kept = std::remove_if(known.pids.begin(), known.pids.begin() + known.count,
+                               [name](pid_t pid) { return !process_matches(pid, name); });
+    known.count = static_cast<size_t>(kept - known.pids.begin());
+    return known.count;
+}
+
+// argv of a process: cmdline is NUL separated, read in one go
+auto get_process_args(const pid_t pid) -> std::vector<std::string> {
+    std::array<char, 64> path;
+    int fd = open(proc_path(path, pid, "cmdline"), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw std::runtime_error("Cannot read process arguments");
+    }
+
+    std::array<char, 16 * 1024> buf;
+    ssize_t len = read(fd, buf.data(), buf.size());
+    close(fd);
+    if (len < 0) {
         throw std::runtime_error("Cannot read process arguments");
     }
-    
-    std::string info;
-    std::getline(file, info);
-    return info;
+
+    std::vector<std::string> args;
+    std::string_view cmdline(buf.data(), static_cast<size_t>(len));
+    while (!cmdline.empty()) {
+        auto end = cmdline.find('\0');
+        args.emplace_back(cmdline.substr(0, end));
+        if (end == std::string_view::npos) break;
+        cmdline.remove_prefix(end + 1);
+    }
+    return args;
 }
 
-// Execute command and return stdout
-auto execute_command(const std::string_view command) -> std::string {
+// The event loop blocks SIGINT/SIGTERM/SIGHUP for its signalfd; exec'd
+// children and the shutdown path need the default delivery back
+auto unblock_signals() -> void {
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+}
+
+// A listening socket, not just a stale file left behind by a dead server
+auto unix_socket_accepts(const std::string& path) -> bool {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::copy(path.begin(), path.end(), addr.sun_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return false;
+    bool accepted = connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    close(fd);
+    return accepted;
+}
+
+// Readers (waybar on SIGUSR2) see either the old or the new file, never a
+// truncated one. The temp file lives next to the symlink target so rename()
+// stays on one filesystem and a dotfiles symlink is left in place. The parts
+// go out with one writev, nobody has to concatenate them first.
+auto replace_file(const std::string& path, std::initializer_list<std::string_view> parts, bool durable) -> size_t {
+    std::error_code ec;
+    const std::string target = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec) {
+        throw std::runtime_error("Cannot resolve " + path + ": " + ec.message());
+    }
+    const std::string temp = target + ".autowaybar-tmp";
+
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        throw std::runtime_error("Cannot create " + temp + ": " + strerror(errno));
+    }
+    struct stat original{};
+    if (stat(target.c_str(), &original) == 0) {
+        fchmod(fd, original.st_mode & 07777);
+    }
+
+    std::array<iovec, 8> iov{};
+    size_t count = 0;
+    size_t total = 0;
+    for (auto part : parts) {
+        if (count == iov.size()) break;
+        iov[count++] = {const_cast<char*>(part.data()), part.size()};
+        total += part.size();
+    }
+
+    // writev may stop early, resume from where it did
+    size_t first = 0;
+    bool ok = true;
+    while (first < count) {
+        ssize_t n = writev(fd, iov.data() + first, static_cast<int>(count - first));
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        auto done = static_cast<size_t>(n);
+        while (first < count && done >= iov[first].iov_len) {
+            done -= iov[first++].iov_len;
+        }
+        if (first < count) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + done;
+            iov[first].iov_len -= done;
+        }
+    }
+    if (ok && durable) ok = fdatasync(fd) == 0;
+    int saved_errno = errno;
+    ok = close(fd) == 0 && ok;
+
+    if (!ok || rename(temp.c_str(), target.c_str()) == -1) {
+        saved_errno = ok ? errno : saved_errno;
+        unlink(temp.c_str());
+        throw std::runtime_error("Cannot write " + target + ": " + strerror(saved_errno));
+    }
+    return total;
+}
+
+// symlink() refuses to overwrite, so build the new link aside and rename it in
+auto replace_symlink(const std::string& target, const std::string& link) -> void {
+    const std::string temp = link + ".autowaybar-tmp";
+    unlink(temp.c_str());
+    if (symlink(target.c_str(), temp.c_str()) == -1 || rename(temp.c_str(), link.c_str()) == -1) {
+        int saved_errno = errno;
+        unlink(temp.c_str());
+        throw std::runtime_error("Cannot point " + link + " at " + target + ": " + strerror(saved_errno));
+    }
+}
+
+// One "Field:   1234 kB" line of /proc/<pid>/status
+auto process_memory_kb(pid_t pid, std::string_view field) -> long {
+    std::array<char, 64> path;
+    int fd = open(proc_path(path, pid, "status"), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    std::array<char, 4096> buf;
+    ssize_t len = read(fd, buf.data(), buf.size());
+    close(fd);
+    if (len <= 0) {
+        return -1;
+    }
+
+    std::string_view status(buf.data(), static_cast<size_t>(len));
+    for (size_t pos = 0; pos < status.size();) {
+        size_t eol = status.find('\n', pos);
+        std::string_view line = status.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+        if (line.starts_with(field) && line.size() > field.size() && line[field.size()] == ':') {
+            line.remove_prefix(field.size() + 1);
+            while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+            long kb = -1;
+            std::from_chars(line.data(), line.data() + line.size(), kb);
+            return kb;
+        }
+        if (eol == std::string_view::npos) break;
+        pos = eol + 1;
+    }
+    return -1;
+}
+
+// glibc 2.36 wraps these in <sys/pidfd.h>, older ones don't: use the syscalls
+auto open_pidfd(pid_t pid) -> int {
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+}
+
+auto signal_pidfd(int pidfd, int signal) -> int {
+    return static_cast<int>(syscall(SYS_pidfd_send_signal, pidfd, signal, nullptr, 0));
+}
+
+// true once the process has exited (a zombie counts), false on timeout
+auto wait_for_exit(int pidfd, std::chrono::milliseconds timeout) -> bool {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd pfd{.fd = pidfd, .events = POLLIN, .revents = 0};
+        int ready = poll(&pfd, 1, static_cast<int>(std::max<long long>(remaining.count(), 0)));
+        if (ready == -1 && errno == EINTR) continue;
+        return ready > 0;
+    }
+}
+
+// SIGTERM, wait up to grace for the exit, then SIGKILL. Reaps the process
+// if it was our child. Returns as soon as the process is gone.
+auto terminate_process(pid_t pid, std::chrono::milliseconds grace) -> void {
+    int pidfd = open_pidfd(pid);
+    if (pidfd == -1) {
+        if (errno != ESRCH) kill(pid, SIGTERM); // no pidfd support, best effort
+        return;
+    }
+    if (signal_pidfd(pidfd, SIGTERM) == 0 && !wait_for_exit(pidfd, grace)) {
+        log_message(WARN, "Force killing process {}\n", pid);
+        signal_pidfd(pidfd, SIGKILL);
+        wait_for_exit(pidfd, grace);
+    }
+    waitpid(pid, nullptr, WNOHANG);
+    close(pidfd);
+}
+
+// The same search posix_spawnp does: a name with a slash is taken as is,
+// anything else is looked up in PATH (glibc's default when unset), an empty
+// entry meaning the current directory
+auto find_executable(std::string_view name) -> std::string {
+    if (name.empty()) return {};
+    if (name.find('/') != std::string_view::npos) {
+        return access(std::string(name).c_str(), X_OK) == 0 ? std::string(name) : std::string{};
+    }
+    const char* path_env = std::getenv("PATH");
+    std::string_view path = path_env ? path_env : "/bin:/usr/bin";
+    while (true) {
+        const auto colon = path.find(':');
+        const auto dir = path.substr(0, colon);
+        std::string candidate = fmt::format("{}/{}", dir.empty() ? "." : dir, name);
+        struct stat st;
+        if (access(candidate.c_str(), X_OK) == 0 && stat(candidate.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            return candidate;
+        }
+        if (colon == std::string_view::npos) return {};
+        path.remove_prefix(colon + 1);
+    }
+}
+
+// Spawns argv[0] (searched in PATH) without copying our address space:
+// glibc's posix_spawn uses CLONE_VM|CLONE_VFORK. The child starts with an
+// empty signal mask; stdout_fd, when given, becomes its stdout and stderr
+// goes to /dev/null. Returns the child pid or -1.
+auto spawn_process(const char* const argv[], int stdout_fd) -> pid_t {
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_init(&attr);
+    posix_spawn_file_actions_init(&actions);
+
+    sigset_t none;
+    sigemptyset(&none);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    if (stdout_fd != -1) {
+        posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+
+    pid_t pid = -1;
+    int err = posix_spawnp(&pid, argv[0], &actions, &attr, const_cast<char* const*>(argv), environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+// Runs a command and captures stdout into a buffer reused across calls.
+// Arguments are split on whitespace into fixed storage, no allocation.
+// A command that outlives timeout is killed and reported as status -1.
+auto run_command(const std::string_view command, std::chrono::milliseconds timeout) -> command_result_t {
+    constexpr size_t MAX_COMMAND_LENGTH = 512;
+    constexpr size_t MAX_ARGS = 16;
+    std::array<char, MAX_COMMAND_LENGTH> storage;
+    std::array<const char*, MAX_ARGS + 1> argv{};
     if (command.empty()) return {};
-    
-    // Split command into arguments for execv
-    std::vector<std::string> args;
-    std::stringstream ss;
-    ss << command;
-    std::string arg;
-    while (ss >> arg) {
-        args.push_back(arg);
-    }
-    
-    if (args.empty()) return {};
-    
-    // Create argv array for execv
-    std::vector<char*> argv;
-    for (auto& arg : args) {
-        argv.push_back(const_cast<char*>(arg.c_str()));
-    }
-    argv.push_back(nullptr);
-    
-    // Use pipe and fork for safe execution
+    if (command.size() >= storage.size()) {
+        log_message(ERR, "Command longer than {} characters, not run: {}\n", MAX_COMMAND_LENGTH - 1, command);
+        return {};
+    }
+
+    // a truncated argument list would run a different command
+    size_t argc = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < command.size(); ) {
+        while (i < command.size() && std::isspace(static_cast<unsigned char>(command[i]))) ++i;
+        if (i == command.size()) break;
+        if (argc == MAX_ARGS) {
+            log_message(ERR, "Command has more than {} arguments, not run: {}\n", MAX_ARGS, command);
+            return {};
+        }
+        argv[argc++] = storage.data() + pos;
+        while (i < command.size() && !std::isspace(static_cast<unsigned char>(command[i]))) storage[pos++] = command[i++];
+        storage[pos++] = '\0';
+    }
+    if (argc == 0) return {};
+
     int pipefd[2];
-    if (pipe(pipefd) == -1) return {};
-    
-    pid_t pid = fork();
-    if (pid == 0) {
-        // Child process
+    if (pipe2(pipefd, O_CLOEXEC) == -1) return {};
+
+    pid_t pid = spawn_process(argv.data(), pipefd[1]);
+    close(pipefd[1]);
+    if (pid == -1) {
         close(pipefd[0]);
-        dup2(pipefd[1], STDOUT_FILENO);
-        // Redirect stderr to /dev/null to avoid mixing with stdout
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull != -1) {
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
+        return {};
+    }
+
+    // grows once to the largest reply seen, then stays
+    static thread_local std::vector<char> buffer(16 * 1024);
+    size_t used = 0;
+    bool timed_out = false;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd pfd{.fd = pipefd[0], .events = POLLIN, .revents = 0};
+        int ready = remaining.count() > 0 ? poll(&pfd, 1, static_cast<int>(remaining.count())) : 0;
+        if (ready == -1 && errno == EINTR) continue;
+        if (ready <= 0) {
+            timed_out = true;
+            break;
         }
-        close(pipefd[1]);
-        
-        execv(argv[0], argv.data());
-        std::exit(1);
-    } else if (pid > 0) {
-        // Parent process
-        close(pipefd[1]);
-        
-        constexpr size_t BUFFER_SIZE = 128;
-        char buffer[BUFFER_SIZE];
-        std::string result;
-        
-        ssize_t bytes_read;
-        while ((bytes_read = read(pipefd[0], buffer, sizeof(buffer) - 1)) > 0) {
-            buffer[bytes_read] = '\0';
-            result += buffer;
+
+        if (used == buffer.size()) buffer.resize(buffer.size() * 2);
+        ssize_t bytes_read = read(pipefd[0], buffer.data() + used, buffer.size() - used);
+        if (bytes_read <= 0) break;
+        used += bytes_read;
+    }
+    close(pipefd[0]);
+
+    // EOF only means stdout closed; a child that lives on (forked, or slow
+    // to exit) gets the rest of the same deadline before it is killed
+    int status = 0;
+    pid_t reaped = timed_out ? 0 : waitpid(pid, &status, WNOHANG);
+    if (reaped == 0 && !timed_out) {
+        int pidfd = open_pidfd(pid);
+        if (pidfd != -1) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timed_out = !wait_for_exit(pidfd, std::max(remaining, std::chrono::milliseconds(0)));
+            close(pidfd);
+        } else {
+            // no pidfd (pre-5.3 kernel): poll for the exit until the deadline
+            while ((reaped = waitpid(pid, &status, WNOHANG)) == 0 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            timed_out = reaped == 0;
         }
-        
-        close(pipefd[0]);
-        waitpid(pid, nullptr, 0);
-        return result;
     }
-    
-    return {};
+    if (timed_out) {
+        kill(pid, SIGKILL);
+    }
+    if (reaped == 0) {
+        while ((reaped = waitpid(pid, &status, 0)) == -1 && errno == EINTR) {}
+    }
+
+    command_result_t result;
+    result.output = std::string_view(buffer.data(), used);
+    // a failed waitpid leaves status unset, which must not read as success
+    if (!timed_out && reaped == pid) {
+        result.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    }
+    return result;
+}
+
+// Execute command and return stdout, empty unless it exited with status 0
+auto execute_command(const std::string_view command) -> std::string {
+    command_result_t result = run_command(command);
+    if (result.status != 0) return {};
+    return std::string(result.output);
 }
@@ -6,8 +6,12 @@
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 #include <fmt/color.h>
-#include <json/json.h>
+#include <array>
+#include <chrono>
+#include <initializer_list>
 #include <string>
+#include <string_view>
+#include <vector>
 
 enum LogLevel {
     NONE = -1,
@@ -19,8 +23,42 @@ enum LogLevel {
     TRACE
 };
 
-auto get_process_args(const pid_t pid) -> std::string;
+// stdout and exit status of a finished command
+struct command_result_t {
+    int status = -1;          // exit code, 128 + signal, -1 if it could not run or timed out
+    std::string_view output;  // valid until the next run_command on this thread
+};
+
+// pids found by a /proc scan, fixed capacity so scanning never allocates
+struct process_list_t {
+    static constexpr size_t MAX_PROCESSES = 32;
+    std::array<pid_t, MAX_PROCESSES> pids{};
+    size_t count = 0;
+
+    auto begin() const { return pids.begin(); }
+    auto end() const { return pids.begin() + count; }
+};
+
+auto find_processes(std::string_view name, process_list_t& found) -> size_t;
+auto revalidate_processes(std::string_view name, process_list_t& known) -> size_t;
+auto get_process_args(const pid_t pid) -> std::vector<std::string>;
+auto process_memory_kb(pid_t pid, std::string_view field) -> long; // VmRSS, RssAnon, ... from /proc/<pid>/status
+auto spawn_process(const char* const argv[], int stdout_fd = -1) -> pid_t;
+auto find_executable(std::string_view name) -> std::string; // where spawn_process would find it, empty if nowhere
+auto run_command(const std::string_view command, std::chrono::milliseconds timeout = std::chrono::seconds(2)) -> command_result_t;
 auto execute_command(const std::string_view command) -> std::string;
+auto unblock_signals() -> void;
+auto unix_socket_accepts(const std::string& path) -> bool;
+// atomic replace through a temp file + rename(), follows symlinks, keeps the mode
+auto replace_file(const std::string& path, std::initializer_list<std::string_view> parts, bool durable = false) -> size_t;
+auto replace_symlink(const std::string& target, const std::string& link) -> void; // atomic retarget
+
+// pidfd (Linux 5.3+): a handle that keeps naming the same process even
+// after its pid is recycled, and becomes readable when that process exits
+auto open_pidfd(pid_t pid) -> int;
+auto signal_pidfd(int pidfd, int signal) -> int;
+auto wait_for_exit(int pidfd, std::chrono::milliseconds timeout) -> bool;
+auto terminate_process(pid_t pid, std::chrono::milliseconds grace) -> void;
 
 template <typename... Args>
 auto log_message(LogLevel level, const std::string &fmt, Args&&... args) -> void {
@@ -2,9 +2,6 @@
 #include <csignal>
 #include <cstdlib>
 #include <exception>
-#include <json/value.h>
-#include <json/reader.h>
-#include <json/writer.h>
 #include <stdexcept>
 #include <sys/types.h>
 #include <thread>
@@ -16,9 +13,17 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/types.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/signalfd.h>
+#include <poll.h>
 #include "utils.hpp"
 #include "Hyprland.hpp"
+#include "jsonpull.hpp"
 #include <filesystem>
+#include <charconv>
+#include <utility>
+#include <limits>
 
 namespace fs = std::filesystem;
 
@@ -27,139 +32,196 @@ std::atomic<bool> g_interrupt_request{false};
 
 // Global workspace tracking
 static std::atomic<int> g_current_workspace{1};
-static std::atomic<bool> g_handling_workspace_change{false};
-static std::atomic<std::chrono::steady_clock::time_point> g_last_workspace_change{std::chrono::steady_clock::now()};
-static std::atomic<std::chrono::steady_clock::time_point> g_workspace_show_start{std::chrono::steady_clock::now()};
 
-// Auxiliary functions
+struct bar_transition_t {
+    BarState from;
+    BarEvent event;
+    BarState to;
+};
+
+// Every visibility change in every mode; events with no row here are ignored
+static constexpr std::array<bar_transition_t, 12> BAR_TRANSITIONS = {{
+    {BarState::Hidden, BarEvent::EnterZone,       BarState::Arming},
+    {BarState::Hidden, BarEvent::Reveal,          BarState::Shown},
+    {BarState::Hidden, BarEvent::Predicted,       BarState::Shown},
+    {BarState::Arming, BarEvent::LeaveZone,       BarState::Hidden},
+    {BarState::Arming, BarEvent::ArmElapsed,      BarState::Shown},
+    {BarState::Arming, BarEvent::Reveal,          BarState::Shown},
+    {BarState::Arming, BarEvent::Predicted,       BarState::Shown},
+    {BarState::Shown,  BarEvent::PastThreshold,   BarState::Hiding},
+    {BarState::Shown,  BarEvent::HoldElapsed,     BarState::Hiding},
+    {BarState::Hiding, BarEvent::WithinThreshold, BarState::Shown},
+    {BarState::Hiding, BarEvent::HideElapsed,     BarState::Hidden},
+    {BarState::Hiding, BarEvent::Reveal,          BarState::Shown},
+}};
+
+static constexpr auto barStateName(BarState state) -> std::string_view {
+    switch (state) {
+    case BarState::Hidden: return "hidden";
+    case BarState::Arming: return "arming";
+    case BarState::Shown:  return "shown";
+    case BarState::Hiding: return "hiding";
+    }
+    return "?";
+}
 
+// Auxiliary functions
 
-auto is_cursor_in_monitor(const monitor_info_t &mon, int x, int y) -> bool {
-    return mon.x_coord <= x &&
-           mon.x_coord + mon.width >= x &&
-           mon.y_coord <= y &&
-           mon.y_coord + mon.height >= y;
+// Monitor names are plain ASCII in practice; quotes and backslashes are escaped anyway
+static auto appendJsonString(std::string& out, std::string_view text) -> void {
+    out.push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        out.push_back(c);
+    }
+    out.push_back('"');
 }
 
+
 // Waybar functions
 
-// reloads waybar with the new visible monitors
+// Queues a visibility change. The first change opens a short window; when it
+// closes, the merged state is written once, or not at all if it ended up
+// equal to what waybar already has (a cursor crossing several monitors).
 auto Waybar::requestApplyVisibleMonitors(bool need_reload) -> void {
-    if (need_reload) {
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Updating\n");
-        }
-        Json::Value arr(Json::arrayValue);
-        for (const auto& mon : m_outputs) {
-            if (!mon.hidden)
-                arr.append(mon.name);
+    if (!need_reload || m_hidden == m_requested_hidden) {
+        return;
+    }
+    m_requested_hidden = m_hidden;
+    ++m_reload_stats.changes;
+
+    if (m_reload_window == 0ms) {
+        flushVisibleMonitors();
+        return;
+    }
+    if (!m_reload_pending) {
+        m_reload_pending = true;
+        m_loop.armTimer(m_reload_timer, std::chrono::steady_clock::now() + m_reload_window);
+    }
+}
+
+auto Waybar::flushVisibleMonitors() -> void {
+    m_reload_pending = false;
+    if (m_hidden == m_applied_hidden) {
+        if (m_verbose_level >= 2) {
+            log_message(TRACE, "Visibility changes cancelled out, skipping reload\n");
         }
-        setOutputs(arr);
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "New update: {}", fmt::streamed(getOutputs()));
+        return;
+    }
+    ++m_reload_stats.reloads;
+    writeVisibleMonitors();
+}
+
+auto Waybar::writeVisibleMonitors() -> void {
+    if (m_reload_pending) {
+        m_reload_pending = false;
+        m_loop.disarmTimer(m_reload_timer); // this write covers it
+    }
+    if (m_hypr_commands.enabled()) {
+        sendHyprCommands(false);
+        m_applied_hidden = m_hidden;
+        m_requested_hidden = m_hidden;
+        return;
+    }
+    if (m_use_pool) {
+        m_applied_hidden = m_hidden;
+        m_requested_hidden = m_hidden;
+        for (size_t i = 0; i < m_waybars.size(); ++i) {
+            syncWaybar(i);
         }
-        reloadPid(); // always reload to apply changes
+        return;
+    }
+    if (m_verbose_level >= 1) {
+        log_message(LOG, "Updating\n");
     }
+    selectConfigVariant();
+    m_applied_hidden = m_hidden;
+    m_requested_hidden = m_hidden;
+    if (m_verbose_level >= 1) {
+        log_message(LOG, "New update: {}\n", renderOutputs(m_hidden));
+    }
+    reloadPid(); // always reload to apply changes
 }
 
- 
-auto Waybar::checkWaybarCrashLimit() -> bool {
-    auto now = std::chrono::steady_clock::now();
-    
-    // Reset crash count if window has expired
-    if (now - m_crash_window_start > Constants::WAYBAR_CRASH_WINDOW) {
-        m_waybar_crash_count = 0;
-        m_crash_window_start = now;
+// Every monitor whose bar changed goes into one IPC request and waybar is
+// never signalled. Tracked by name, so hotplug re-indexing does not matter.
+auto Waybar::sendHyprCommands(bool show_all) -> void {
+    std::vector<std::string> names, wanted;
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+        names.push_back(m_outputs[i].name);
+        if (m_hidden[i] && !show_all) wanted.push_back(m_outputs[i].name);
     }
-    
-    // Check if we've exceeded the crash limit
-    if (m_waybar_crash_count >= Constants::MAX_WAYBAR_CRASHES) {
-        return true; // Too many crashes
+    std::string batch = hyprSyncHidden(m_hypr_commands, names, wanted, m_hypr_hidden);
+    if (!batch.empty() && m_verbose_level >= 1) {
+        log_message(LOG, "Hyprland: {}\n", batch);
     }
-    
-    return false; // Within limits
 }
 
+// The visible monitors as a JSON array, in a buffer reused between writes
+auto Waybar::renderOutputs(const hot_zone_table_t::monitor_set_t& hidden) -> std::string_view {
+    m_outputs_text.assign("[");
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+        if (hidden[i]) continue;
+        if (m_outputs_text.size() > 1) m_outputs_text.append(", ");
+        appendJsonString(m_outputs_text, m_outputs[i].name);
+    }
+    m_outputs_text.append("]");
+    return m_outputs_text;
+}
+
+auto Waybar::logReloadStats() const -> void {
+    if (m_verbose_level < 1 || m_reload_stats.changes == 0) {
+        return;
+    }
+    log_message(LOG, "{}: {} sent for {} visibility changes ({} avoided)\n",
+               m_hypr_commands.enabled() ? "Hyprland requests" : m_use_pool ? "Toggles" : "Reloads",
+               m_reload_stats.reloads, m_reload_stats.changes,
+               m_reload_stats.changes - m_reload_stats.reloads);
+}
+
+// Resolves geometry and mon:<names> into the lookup table, once per topology
+auto Waybar::rebuildZones() -> void {
+    m_zones.build(m_outputs, m_bar_threshold,
+                  m_original_mode == BarMode::HIDE_MON ? getTargetMonitors() : std::vector<std::string>{});
+}
+
+ 
+// Probes the session without starting anything: the Wayland and Hyprland
+// sockets must accept connections and Hyprland must report a monitor
 auto Waybar::isEnvironmentReady() -> bool {
-    // Check if we're in a Wayland environment
-    const char* wayland_display = std::getenv("WAYLAND_DISPLAY");
-    if (!wayland_display) {
-        logToFile("WAYLAND_DISPLAY not set - environment not ready\n");
+    auto not_ready = [this](const std::string& reason) {
+        logToFile(reason + " - environment not ready\n");
         if (m_verbose_level >= 1) {
-            log_message(LOG, "WAYLAND_DISPLAY not set - environment not ready\n");
+            log_message(LOG, "{} - environment not ready\n", reason);
         }
         return false;
+    };
+
+    // Check if we're in a Wayland environment
+    const char* wayland_display = std::getenv("WAYLAND_DISPLAY");
+    if (!wayland_display) {
+        return not_ready("WAYLAND_DISPLAY not set");
+    }
+    std::string wayland_socket = wayland_display;
+    if (wayland_socket.front() != '/') {
+        const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+        wayland_socket = std::string(runtime_dir ? runtime_dir : "/tmp") + "/" + wayland_socket;
+    }
+    if (!unix_socket_accepts(wayland_socket)) {
+        return not_ready("Wayland socket " + wayland_socket + " not accepting connections");
     }
     
     // Check if Hyprland is running
     if (!isHyprlandRunning()) {
-        logToFile("Hyprland not running - environment not ready\n");
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Hyprland not running - environment not ready\n");
-        }
-        return false;
-    }
-    
-    // Check if we can get monitor information (basic Hyprland functionality)
-    try {
-        auto monitors = getMonitorsInfo();
-        if (monitors.empty()) {
-            logToFile("No monitors detected - environment not ready\n");
-            if (m_verbose_level >= 1) {
-                log_message(LOG, "No monitors detected - environment not ready\n");
-            }
-            return false;
-        }
-    } catch (const std::exception& e) {
-        logToFile("Failed to get monitor info - environment not ready: " + std::string(e.what()) + "\n");
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Failed to get monitor info - environment not ready: {}\n", e.what());
-        }
-        return false;
+        return not_ready("Hyprland not running");
     }
-    
-    // Check if waybar binary exists and is executable
-    if (access("/usr/bin/waybar", X_OK) != 0) {
-        logToFile("Waybar binary not found or not executable - environment not ready\n");
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Waybar binary not found or not executable - environment not ready\n");
-        }
-        return false;
+    if (!hyprHasMonitors()) {
+        return not_ready("Hyprland socket not answering or no monitors");
     }
     
-    // Test if waybar can actually start (real Wayland session test)
-    pid_t test_pid = fork();
-    if (test_pid == 0) {
-        // Child process - test waybar startup (without --help to test real startup)
-        execlp("waybar", "waybar", nullptr);
-        std::exit(1); // If execlp fails
-    } else if (test_pid > 0) {
-        // Parent process - wait briefly for waybar to start
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        
-        // Check if waybar is running
-        std::string pid_str = execute_command("/usr/sbin/pidof waybar");
-        if (pid_str.empty()) {
-            // Waybar didn't start - kill the test process and fail
-            kill(test_pid, SIGTERM);
-            waitpid(test_pid, nullptr, 0);
-            logToFile("Waybar test startup failed - environment not ready\n");
-            if (m_verbose_level >= 1) {
-                log_message(LOG, "Waybar test startup failed - environment not ready\n");
-            }
-            return false;
-        } else {
-            // Waybar started successfully - kill it and continue
-            kill(test_pid, SIGTERM);
-            waitpid(test_pid, nullptr, 0);
-        }
-    } else {
-        // Fork failed
-        logToFile("Failed to fork for waybar test - environment not ready\n");
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Failed to fork for waybar test - environment not ready\n");
-        }
-        return false;
+    // Check that the waybar the supervisor spawns can be found, the same PATH search
+    if (find_executable("waybar").empty()) {
+        return not_ready("Waybar binary not found in PATH");
     }
     
     logToFile("Environment appears ready for waybar\n");
@@ -169,42 +231,73 @@ auto Waybar::isEnvironmentReady() -> bool {
     return true;
 }
 
+// Sleeps on inotify instead of a fixed retry interval: the compositor
+// creating its sockets under $XDG_RUNTIME_DIR wakes us immediately.
+// ENVIRONMENT_RETRY_INTERVAL only bounds how stale a check can get when
+// readiness changes without a file event (e.g. the first monitor).
 auto Waybar::waitForEnvironmentReady() -> bool {
-    auto now = std::chrono::steady_clock::now();
-    
-    // Initialize retry tracking if this is the first attempt
-    if (m_environment_retry_count == 0) {
-        m_environment_retry_start = now;
-        logToFile("Waiting for environment to be ready for waybar...\n");
-        log_message(INFO, "Waiting for environment to be ready for waybar...\n");
-    }
-    
-    // Check if we've exceeded the timeout
-    if (now - m_environment_retry_start > Constants::ENVIRONMENT_RETRY_TIMEOUT) {
-        logToFile("Environment not ready after 10 minutes - giving up\n");
-        log_message(ERR, "Environment not ready after {} minutes - giving up\n", 
-                   std::chrono::duration_cast<std::chrono::minutes>(Constants::ENVIRONMENT_RETRY_TIMEOUT).count());
-        return false;
-    }
-    
-    // Check if environment is ready
     if (isEnvironmentReady()) {
-        if (m_environment_retry_count > 0) {
-            logToFile("Environment is now ready after " + std::to_string(m_environment_retry_count) + " attempts\n");
-            log_message(INFO, "Environment is now ready after {} attempts\n", m_environment_retry_count);
-        }
         return true;
     }
-    
-    // Environment not ready, increment retry count and wait
-    m_environment_retry_count++;
-    logToFile("Environment not ready (attempt " + std::to_string(m_environment_retry_count) + "), waiting 10 seconds before retry...\n");
-    log_message(LOG, "Environment not ready (attempt {}), waiting {} seconds before retry...\n", 
-               m_environment_retry_count, 
-               std::chrono::duration_cast<std::chrono::seconds>(Constants::ENVIRONMENT_RETRY_INTERVAL).count());
-    
-    std::this_thread::sleep_for(Constants::ENVIRONMENT_RETRY_INTERVAL);
-    return waitForEnvironmentReady(); // Recursive call for next attempt
+
+    auto start = std::chrono::steady_clock::now();
+    logToFile("Waiting for environment to be ready for waybar...\n");
+    log_message(INFO, "Waiting for environment to be ready for waybar...\n");
+
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Peeks at SIGINT/SIGTERM/SIGHUP without consuming them, the event loop
+    // still reads them from its own signalfd afterwards
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    for (int sig : {SIGINT, SIGTERM, SIGHUP}) sigaddset(&stop_signals, sig);
+    int signal_fd = signalfd(-1, &stop_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    std::string base = runtime_dir ? runtime_dir : "/tmp";
+    std::string hypr_dir = hyprInstanceDir();
+    std::array<std::string, 3> watched = {base, base + "/hypr", hypr_dir};
+
+    int attempts = 0;
+    bool ready = false;
+    while (!ready) {
+        if (std::chrono::steady_clock::now() - start > Constants::ENVIRONMENT_RETRY_TIMEOUT) {
+            logToFile("Environment not ready after 10 minutes - giving up\n");
+            log_message(ERR, "Environment not ready after {} minutes - giving up\n", 
+                       std::chrono::duration_cast<std::chrono::minutes>(Constants::ENVIRONMENT_RETRY_TIMEOUT).count());
+            break;
+        }
+
+        // directories that did not exist yet are picked up on the next round
+        for (const auto& dir : watched) {
+            if (inotify_fd != -1 && !dir.empty()) {
+                inotify_add_watch(inotify_fd, dir.c_str(), IN_CREATE | IN_MOVED_TO | IN_ATTRIB);
+            }
+        }
+
+        std::array<pollfd, 2> fds = {{{.fd = inotify_fd, .events = POLLIN, .revents = 0},
+                                      {.fd = signal_fd, .events = POLLIN, .revents = 0}}};
+        int timeout = static_cast<int>(std::chrono::milliseconds(Constants::ENVIRONMENT_RETRY_INTERVAL).count());
+        if (poll(fds.data(), fds.size(), timeout) > 0) {
+            if (fds[1].revents & POLLIN) {
+                log_message(WARN, "Interrupted while waiting for the environment\n");
+                break;
+            }
+            std::array<char, 4096> events;
+            while (read(inotify_fd, events.data(), events.size()) > 0) {}
+        }
+
+        attempts++;
+        ready = isEnvironmentReady();
+    }
+
+    if (inotify_fd != -1) close(inotify_fd);
+    if (signal_fd != -1) close(signal_fd);
+    if (ready) {
+        auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        logToFile("Environment is now ready after " + std::to_string(waited.count()) + "ms\n");
+        log_message(INFO, "Environment is now ready after {}ms ({} checks)\n", waited.count(), attempts);
+    }
+    return ready;
 }
 
 auto Waybar::initLogFile() -> void {
@@ -244,221 +337,193 @@ auto Waybar::logToFile(const std::string& message) -> void {
 }
 
 auto Waybar::enforceSingleWaybar() -> void {
-    std::string existing_pid_str = execute_command("/usr/sbin/pidof waybar");
-    if (existing_pid_str.empty()) {
-        return; // No waybar processes running
+    process_list_t running;
+    if (find_processes("waybar", running) <= 1) {
+        return; // at most one waybar running
     }
     
-    existing_pid_str.erase(existing_pid_str.find_last_not_of(" \t\n\r") + 1);
+    log_message(WARN, "Multiple waybar processes detected ({}), enforcing single waybar policy...\n", running.count);
+    for (pid_t existing_pid : running) {
+        log_message(INFO, "Killing existing waybar process (PID: {})\n", existing_pid);
+        terminate_process(existing_pid, Constants::WAYBAR_STOP_TIMEOUT);
+    }
+}
+
+auto Waybar::initPidOrRestart() -> void {
+    process_list_t running;
+    if (find_processes("waybar", running) == 0) {
+        log_message(INFO, "Waybar not running, attempting to start...\n");
+        startWaybars();
+        return;
+    }
     
-    // Count valid PIDs
-    std::istringstream pid_stream(existing_pid_str);
-    std::string pid_token;
-    int valid_pid_count = 0;
-    while (pid_stream >> pid_token) {
-        try {
-            pid_t pid = std::stoi(pid_token);
-            if (kill(pid, 0) == 0) {
-                valid_pid_count++;
-            }
-        } catch (const std::exception& e) {
-            // Ignore parsing errors
-        }
+    // Always kill existing waybar processes and start our own
+    log_message(INFO, "Existing waybar process(es) detected, killing and starting own child process...\n");
+    for (pid_t existing_pid : running) {
+        log_message(INFO, "Killing existing waybar process (PID: {})\n", existing_pid);
+        terminate_process(existing_pid, Constants::WAYBAR_STOP_TIMEOUT);
+    }
+    if (revalidate_processes("waybar", running) > 0) {
+        log_message(WARN, "{} waybar process(es) survived termination\n", running.count);
     }
     
-    if (valid_pid_count > 1) {
-        log_message(WARN, "Multiple waybar processes detected ({}), enforcing single waybar policy...\n", valid_pid_count);
-        
-        // Kill all waybar processes
-        std::istringstream pid_stream2(existing_pid_str);
-        while (pid_stream2 >> pid_token) {
-            try {
-                pid_t existing_pid = std::stoi(pid_token);
-                
-                // Verify the existing process is actually running
-                if (kill(existing_pid, 0) == 0) {
-                    log_message(INFO, "Killing existing waybar process (PID: {})\n", existing_pid);
-                    if (kill(existing_pid, SIGTERM) == -1) {
-                        log_message(WARN, "Failed to send SIGTERM to waybar process {}: {}\n", existing_pid, strerror(errno));
-                    }
-                    
-                    // Wait for process to die
-                    int attempts = 0;
-                    while (kill(existing_pid, 0) == 0 && attempts < 10) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                        attempts++;
-                    }
-                    
-                    // Force kill if still running
-                    if (kill(existing_pid, 0) == 0) {
-                        log_message(WARN, "Force killing waybar process {}\n", existing_pid);
-                        kill(existing_pid, SIGKILL);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    }
-                }
-            } catch (const std::exception& e) {
-                log_message(WARN, "Failed to parse PID: {}\n", pid_token);
-            }
-        }
+    // Start our own waybar process
+    startWaybars();
+}
+
+// Without --pool one waybar serves every monitor. With it each monitor gets
+// its own waybar, and hiding a monitor is a SIGUSR1 to that process instead
+// of a config switch and a full reload of every bar.
+auto Waybar::startWaybars() -> void {
+    // the config is also loaded in all mode for --warm-standby, so the mode itself decides
+    const bool per_monitor = m_original_mode == BarMode::HIDE_FOCUSED || m_original_mode == BarMode::HIDE_MON;
+    m_use_pool = m_pool_requested && per_monitor && m_outputs.size() > Constants::SINGLE_MONITOR_THRESHOLD &&
+                 !m_hypr_commands.enabled();
+    if (m_pool_requested && !m_use_pool) {
+        log_message(WARN, "--pool needs focused or mon: mode, more than one monitor and no --hypr-hide, starting a single waybar\n");
+    }
+    if (!m_use_pool) {
+        m_waybars.add({}, m_variant_link);
+        return;
     }
+
+    m_reload_window = 0ms; // a toggle touches one process, nothing to coalesce
+    for (const auto& mon : m_outputs) {
+        addPoolInstance(mon.name);
+    }
+    log_message(INFO, "Waybar pool: {} instances\n", m_waybars.size());
 }
 
-auto Waybar::restartWaybar() -> pid_t {
-    logToFile("Starting waybar...\n");
-    log_message(INFO, "Starting waybar...\n");
-    
-    // First, check if environment is ready
-    if (!waitForEnvironmentReady()) {
-        logToFile("Environment not ready for waybar after timeout\n");
-        throw std::runtime_error("Environment not ready for waybar after timeout");
+auto Waybar::addPoolInstance(const std::string& output) -> void {
+    waybar_instance_t bar{.output = output};
+    bar.config = instanceConfigPath(bar);
+    writeOutputConfig(bar.output);
+    m_waybars.add(std::move(bar.output), std::move(bar.config));
+}
+
+// Same splice as the variants, with a one-element output array
+auto Waybar::writeOutputConfig(const std::string& output) -> void {
+    m_outputs_text.assign("[");
+    appendJsonString(m_outputs_text, output);
+    m_outputs_text.push_back(']');
+    std::string_view text(m_config_text);
+    size_t written = replace_file(m_variant_dir + "/output-" + output, {
+        text.substr(0, m_output_span.begin),
+        m_outputs_text,
+        text.substr(m_output_span.end),
+    });
+    ++m_config_writes.writes;
+    m_config_writes.file_bytes += written;
+}
+
+// A fresh waybar shows every bar of its config. Per-monitor modes without
+// the pool start it on the current variant, so only toggled bars and a
+// promoted standby (started hidden) differ from what this returns.
+auto Waybar::wantedVisible(size_t index) const -> bool {
+    const auto& bar = m_waybars[index];
+    if (m_use_pool) {
+        auto mon = std::find_if(m_outputs.cbegin(), m_outputs.cend(), [&bar](const monitor_info_t& m) {
+            return m.name == bar.output;
+        });
+        return mon == m_outputs.cend() ? bar.visible : !m_hidden[static_cast<size_t>(mon - m_outputs.cbegin())];
     }
-    
-    // Reset crash count if it's been more than 30 seconds since last attempt
-    auto now = std::chrono::steady_clock::now();
-    if (now - m_crash_window_start > Constants::WAYBAR_CRASH_WINDOW) {
-        m_waybar_crash_count = 0;
-        m_crash_window_start = now;
+    if (m_policy.per_monitor || m_slots.empty()) {
+        return true;
     }
-    
-    // Check crash limit before attempting restart
-    if (checkWaybarCrashLimit()) {
-        logToFile("Waybar is unstable - crashed 3 times in 30 seconds. Giving up.\n");
-        throw std::runtime_error("Waybar is unstable - crashed 3 times in 30 seconds. Giving up.");
+    return m_slots[0].visible();
+}
+
+auto Waybar::syncWaybar(size_t index) -> void {
+    const bool visible = wantedVisible(index);
+    if (m_waybars[index].visible != visible) {
+        postIntent(index, visible ? WaybarIntent::Show : WaybarIntent::Hide);
     }
-    
-    // Try to start waybar
-    pid_t child_pid = fork();
-    if (child_pid == 0) {
-        // Child process - exec waybar
-        execlp("waybar", "waybar", nullptr);
-        // If execlp fails, exit with error
-        std::exit(1);
-    } else if (child_pid > 0) {
-        // Parent process - wait a moment for waybar to start
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        
-        // Check if waybar is now running
-        std::string pid_str = execute_command("/usr/sbin/pidof waybar");
-        if (!pid_str.empty()) {
-            pid_str.erase(pid_str.find_last_not_of(" \t\n\r") + 1);
-            pid_t actual_pid = std::stoi(pid_str);
-            logToFile("Waybar started successfully with PID: " + std::to_string(actual_pid) + "\n");
-            log_message(INFO, "Waybar started successfully with PID: {}\n", actual_pid);
-            return actual_pid;
+}
+
+auto Waybar::postIntent(size_t index, WaybarIntent kind) -> void {
+    m_intents.post({.instance = m_waybars[index].id, .kind = kind}); // a full queue resyncs on drain
+}
+
+// Intents are folded per instance before anything is sent: the last show or
+// hide wins and reloads merge, so a hide that was taken back in the same
+// batch never reaches waybar. A reload is never sent next to a SIGUSR1,
+// which would overtake it; a bar that ends up hidden is marked stale instead
+// and reloads when it is shown.
+auto Waybar::drainIntents() -> void {
+    m_intent_batch.clear();
+    const bool overflowed = m_intents.drain(m_intent_batch);
+    if (m_intent_batch.empty() && !overflowed) {
+        return;
+    }
+    m_intent_stats.intents += static_cast<int>(m_intent_batch.size());
+    m_intent_folds.assign(m_waybars.size(), {-1, false});
+    for (const auto& intent : m_intent_batch) {
+        const size_t index = m_waybars.indexOf(intent.instance);
+        if (index == m_waybars.size()) continue; // removed since
+        auto& [visible, reload] = m_intent_folds[index];
+        if (intent.kind == WaybarIntent::Reload) {
+            reload = true;
         } else {
-            // Waybar failed to start - check if it's an environment issue
-            if (!isEnvironmentReady()) {
-                // Environment became unready - don't count this as a crash
-                logToFile("Environment became unready during waybar startup - not counting as crash\n");
-                log_message(WARN, "Environment became unready during waybar startup - not counting as crash\n");
-                throw std::runtime_error("Environment became unready during waybar startup");
-            } else {
-                // Environment is ready but waybar failed - count as crash
-                if (m_waybar_crash_count == 0) {
-                    m_crash_window_start = std::chrono::steady_clock::now();
-                }
-                m_waybar_crash_count++;
-                logToFile("Failed to start waybar - process not found after startup (crash count: " + std::to_string(m_waybar_crash_count) + ")\n");
-                throw std::runtime_error("Failed to start waybar - process not found after startup");
-            }
+            visible = intent.kind == WaybarIntent::Show;
         }
-    } else {
-        // Fork failed - check if it's an environment issue
-        if (!isEnvironmentReady()) {
-            // Environment became unready - don't count this as a crash
-            logToFile("Environment became unready during fork - not counting as crash\n");
-            log_message(WARN, "Environment became unready during fork - not counting as crash\n");
-            throw std::runtime_error("Environment became unready during fork");
-        } else {
-            // Environment is ready but fork failed - count as crash
-            if (m_waybar_crash_count == 0) {
-                m_crash_window_start = std::chrono::steady_clock::now();
-            }
-            m_waybar_crash_count++;
-            logToFile("Failed to fork process for waybar start: " + std::string(strerror(errno)) + " (crash count: " + std::to_string(m_waybar_crash_count) + ")\n");
-            throw std::runtime_error("Failed to fork process for waybar start: " + std::string(strerror(errno)));
+    }
+    if (overflowed) {
+        ++m_intent_stats.overflows;
+        log_message(WARN, "Intent queue overflowed, resyncing every waybar\n");
+        for (size_t i = 0; i < m_waybars.size(); ++i) {
+            m_intent_folds[i].first = wantedVisible(i);
         }
     }
-}
 
-auto Waybar::initPid() const -> pid_t {
-    std::string pid_str = execute_command("/usr/sbin/pidof waybar");
-    if (pid_str.empty()) {
-        throw std::runtime_error("Waybar is not running");
-    }
-    
-    pid_str.erase(pid_str.find_last_not_of(" \t\n\r") + 1);
-    
-    // Handle multiple PIDs (pidof can return multiple PIDs separated by spaces)
-    std::istringstream pid_stream(pid_str);
-    std::string pid_token;
-    while (pid_stream >> pid_token) {
-        try {
-            pid_t pid = std::stoi(pid_token);
-            
-            // Verify the process is actually running
-            if (kill(pid, 0) == 0) {
-                return pid;
+    for (size_t i = 0; i < m_waybars.size(); ++i) {
+        auto& bar = m_waybars[i];
+        const auto [wanted, reload] = m_intent_folds[i];
+        const bool visible = wanted < 0 ? bar.visible : wanted == 1;
+        if (reload) {
+            if (bar.visible && visible) {
+                m_intent_stats.signals += m_waybars.signal(i, SIGUSR2); // one that is restarting reads it anyway
+            } else {
+                bar.stale = true;
             }
-        } catch (const std::exception& e) {
-            log_message(WARN, "Failed to parse PID: {}\n", pid_token);
+        }
+        if (!setWaybarVisible(i, visible)) {
+            continue;
+        }
+        ++m_intent_stats.signals;
+        if (m_verbose_level < 1) continue;
+        if (!bar.output.empty()) {
+            log_message(LOG, "Toggled waybar on {} (PID: {})\n", bar.output, bar.pid);
+        } else {
+            log_message(LOG, visible ? "Opening it. \n" : "Hiding it. \n");
         }
     }
-    
-    throw std::runtime_error("No valid waybar processes found");
 }
 
-auto Waybar::initPidOrRestart() -> pid_t {
-    // First check if environment is ready
-    if (!waitForEnvironmentReady()) {
-        throw std::runtime_error("Environment not ready for waybar after timeout");
-    }
-    
-    std::string pid_str = execute_command("/usr/sbin/pidof waybar");
-    if (pid_str.empty()) {
-        log_message(INFO, "Waybar not running, attempting to start...\n");
-        return restartWaybar();
+// Instances are keyed by output name, so a re-sorted m_outputs does not matter
+auto Waybar::syncPoolTopology() -> void {
+    auto known = [this](const std::string& name) {
+        return std::any_of(m_outputs.cbegin(), m_outputs.cend(), [&name](const monitor_info_t& m) {
+            return m.name == name;
+        });
+    };
+    for (size_t i = m_waybars.size(); i-- > 0;) {
+        if (known(m_waybars[i].output)) continue;
+        log_message(INFO, "Stopping waybar for removed monitor {}\n", m_waybars[i].output);
+        const std::string key = instanceConfigPath(m_waybars[i]);
+        m_waybars.remove(i);
+        std::error_code ec;
+        for (const char* suffix : {"", ".hidden", ".standby-0", ".standby-1"}) {
+            fs::remove(key + suffix, ec);
+        }
     }
-    
-    // Always kill existing waybar processes and start our own
-    log_message(INFO, "Existing waybar process(es) detected, killing and starting own child process...\n");
-    
-    // Kill all existing waybar processes
-    pid_str.erase(pid_str.find_last_not_of(" \t\n\r") + 1);
-    std::istringstream pid_stream(pid_str);
-    std::string pid_token;
-    while (pid_stream >> pid_token) {
-        try {
-            pid_t existing_pid = std::stoi(pid_token);
-            
-            // Verify the existing process is actually running
-            if (kill(existing_pid, 0) == 0) {
-                log_message(INFO, "Killing existing waybar process (PID: {})\n", existing_pid);
-                if (kill(existing_pid, SIGTERM) == -1) {
-                    log_message(WARN, "Failed to send SIGTERM to waybar process {}: {}\n", existing_pid, strerror(errno));
-                }
-                
-                // Wait for process to die
-                int attempts = 0;
-                while (kill(existing_pid, 0) == 0 && attempts < 10) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    attempts++;
-                }
-                
-                // Force kill if still running
-                if (kill(existing_pid, 0) == 0) {
-                    log_message(WARN, "Force killing waybar process {}\n", existing_pid);
-                    kill(existing_pid, SIGKILL);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                }
-            }
-        } catch (const std::exception& e) {
-            log_message(WARN, "Failed to parse PID: {}\n", pid_token);
+    for (const auto& mon : m_outputs) {
+        bool running = std::any_of(m_waybars.begin(), m_waybars.end(), [&mon](const waybar_instance_t& bar) {
+            return bar.output == mon.name;
+        });
+        if (!running) {
+            addPoolInstance(mon.name);
         }
     }
-    
-    // Start our own waybar process
-    return restartWaybar();
 }
 
 // Parse mode argument
@@ -481,42 +546,111 @@ auto Waybar::parseMode(const std::string &mode) -> BarMode {
 }
 
 
-Waybar::Waybar(const std::string &mode, int threshold, int verbose, const std::string &config_dir)
-    : m_original_mode(parseMode(mode)),
+Waybar::Waybar(const std::string &mode, int threshold, int verbose, const std::string &config_dir,
+               std::chrono::milliseconds reload_window, bool pool, hypr_commands_t hypr_commands, bool standby,
+               bool predict, const std::string &trace_path)
+    : m_pool_requested(pool),
+      m_standby(standby),
+      m_waybars(m_loop, {.environment_ready = [this] { return isEnvironmentReady(); },
+                         .on_up = [this](size_t index) { handleWaybarUp(index); },
+                         .log_to_file = [this](const std::string& message) { logToFile(message); },
+                         .prepare_standby = [this](size_t index) { return prepareStandby(index); },
+                         .on_promote = [this](size_t index) { promoteStandby(index); }}),
+      m_hypr_commands(std::move(hypr_commands)),
+      m_original_mode(parseMode(mode)),
       m_is_console(isatty(fileno(stdin))),
       m_verbose_level(verbose),
       m_bar_threshold(threshold),
-      m_config_dir(config_dir),
-      m_waybar_crash_count(0),
-      m_crash_window_start(std::chrono::steady_clock::now()) {
-    // Crash tracking already initialized in member initializer list
+      m_sampler([this] { return takeSnapshot(); }),
+      m_predict(predict),
+      m_reload_window(reload_window),
+      m_config_dir(config_dir) {
+
+    // Signals arrive through the event loop instead of an async handler
+    m_loop.watchSignals({SIGINT, SIGTERM, SIGHUP}, [this](int signal) {
+        log_message(WARN, "Signal {} received, initiating graceful shutdown...\n", signal);
+        g_interrupt_request.store(true, std::memory_order_release);
+        m_loop.interrupt();
+    });
     
     // Initialize logging first
     initLogFile();
     logToFile("autowaybar starting with mode: " + mode + "\n");
+
+    if (!trace_path.empty()) {
+        m_trace.open(trace_path, std::ios::app);
+        if (!m_trace) {
+            throw std::runtime_error("Cannot open trace file " + trace_path);
+        }
+        m_trace << "# autowaybar cursor trace: t_us x y monitor zone_edge\n";
+    }
     
-    // Get waybar PID (will kill existing processes and start our own)
-    m_waybar_pid = initPidOrRestart();
+    // Startup is reported by phase so slow logins can be attributed
+    auto startup_begin = std::chrono::steady_clock::now();
+    if (!waitForEnvironmentReady()) {
+        throw std::runtime_error("Environment not ready for waybar");
+    }
+    auto environment_ready = std::chrono::steady_clock::now();
     
+    // Per-monitor modes start waybar on a config variant, so the config comes
+    // first; a standby needs it in every mode for its hidden copy
+    const bool per_monitor = m_original_mode == BarMode::HIDE_FOCUSED || m_original_mode == BarMode::HIDE_MON;
+    if (per_monitor || m_standby) {
+        initConfig();
+    }
+    if (!per_monitor && m_hypr_commands.enabled()) {
+        log_message(WARN, "--hypr-hide only applies to focused and mon: modes, hiding all bars with SIGUSR1\n");
+    }
+    if (m_standby) {
+        m_waybars.enableStandby();
+    }
+
+    // The monitors decide whether --pool starts one waybar or several
     initialize();
+    auto initialized = std::chrono::steady_clock::now();
+
+    // Get waybar PID (will kill existing processes and start our own)
+    initPidOrRestart();
+    auto startup_end = std::chrono::steady_clock::now();
+
+    auto ms = [](auto duration) { return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(); };
+    logToFile(fmt::format("Startup: environment {}ms, initialization {}ms, waybar {}ms, total {}ms\n",
+                          ms(environment_ready - startup_begin), ms(initialized - environment_ready),
+                          ms(startup_end - initialized), ms(startup_end - startup_begin)));
+    log_message(INFO, "Startup: environment {}ms, initialization {}ms, waybar {}ms, total {}ms\n",
+                ms(environment_ready - startup_begin), ms(initialized - environment_ready),
+                ms(startup_end - initialized), ms(startup_end - startup_begin));
 }
 
 auto Waybar::initialize() -> void {
     m_outputs = getMonitorsInfo();
+    rebuildZones();
     
     // Initialize global workspace tracking
-    g_current_workspace.store(getCurrentWorkspace(), std::memory_order_release);
-    
-    // Initialize waybar state - assume it starts visible
-    m_waybar_visible = true;
-    
-    // Initialize mouse activation tracking
-    m_mouse_in_activation_zone = false;
-    
-    // Only initialize config for modes that need it (focused and custom modes)
-    if (m_original_mode == BarMode::HIDE_FOCUSED || m_original_mode == BarMode::HIDE_MON) {
-        initConfig();
+    m_events.fd = hyprConnectEvents();
+    m_events_live.store(m_events.fd != -1, std::memory_order_release);
+    g_current_workspace.store(takeSnapshot().workspace, std::memory_order_release);
+    if (m_events.fd == -1) {
+        log_message(WARN, "Hyprland event socket unavailable, polling workspaces through hyprctl\n");
+    } else {
+        m_loop.watch(m_events.fd, [this] { readEvents(); });
     }
+
+    m_workspace_hide_timer = m_loop.addTimer([this] {
+        if (m_verbose_level >= 1) {
+            log_message(LOG, "Workspace reveal expired\n");
+        }
+        m_loop.interrupt(); // the next tick lets revealed bars hide
+    });
+    m_predict_hold_timer = m_loop.addTimer([this] { m_loop.interrupt(); });
+    m_reload_timer = m_loop.addTimer([this] { flushVisibleMonitors(); });
+    m_loop.watch(m_intents.fd(), [this] { drainIntents(); });
+    m_loop.watch(m_sampler.fd(), [this] {
+        m_sampler.acknowledge();
+        m_sample_ready = true;
+        m_loop.interrupt();
+    });
+    m_poll_stats_start = std::chrono::steady_clock::now();
 }
 
 Waybar::~Waybar() {
@@ -527,18 +661,27 @@ Waybar::~Waybar() {
             restoreOriginal();
         }
         reloadPid();
+        removeConfigVariants();
     } catch (const std::exception& e) {
         logToFile("Error during cleanup: " + std::string(e.what()) + "\n");
         log_message(ERR, "Error during cleanup: {}", e.what());
     }
     
+    if (m_events.fd != -1) {
+        close(m_events.fd);
+    }
+    if (m_config_watch_fd != -1) {
+        close(m_config_watch_fd);
+    }
+
     // Close log file
     if (m_log_file.is_open()) {
         logToFile("autowaybar shutting down\n");
         m_log_file.close();
     }
-    
-    cleanupSignals();
+
+    // the loop blocked these for its signalfd; teardown is done, so defaults apply again
+    unblock_signals();
 }
 
 auto Waybar::run() -> void {
@@ -568,19 +711,7 @@ auto Waybar::runCustomMode() -> void {
 }
 
 auto Waybar::validateMonitorExists() -> void {
-    // Split comma-separated monitor names
-    std::vector<std::string> monitor_names;
-    std::stringstream ss(m_hidemon);
-    std::string monitor;
-    
-    while (std::getline(ss, monitor, ',')) {
-        // Trim whitespace
-        monitor.erase(0, monitor.find_first_not_of(" \t"));
-        monitor.erase(monitor.find_last_not_of(" \t") + 1);
-        if (!monitor.empty()) {
-            monitor_names.push_back(monitor);
-        }
-    }
+    std::vector<std::string> monitor_names = getTargetMonitors();
     
     if (monitor_names.empty()) {
         log_message(CRIT, "No monitors specified after 'mon:'\n");
@@ -612,20 +743,8 @@ auto Waybar::validateMonitorExists() -> void {
     }
 }
 
-auto Waybar::hideCustom() -> void {
-    if (m_outputs.size() <= Constants::SINGLE_MONITOR_THRESHOLD) {
-        log_message(WARN, "The number of monitors is {}. Fall back to `mode` ALL\n", m_outputs.size());
-        hideAllMonitors();
-        return;
-    }
-
-    setupCustomMode();
-    runCustomModeLoop();
-    cleanupCustomMode();
-}
-
-auto Waybar::setupCustomMode() -> void {
-    // Parse comma-separated monitor names
+// Comma-separated monitor names of mon:<names>, trimmed
+auto Waybar::getTargetMonitors() const -> std::vector<std::string> {
     std::vector<std::string> target_monitors;
     std::stringstream ss(m_hidemon);
     std::string monitor;
@@ -638,121 +757,48 @@ auto Waybar::setupCustomMode() -> void {
             target_monitors.push_back(monitor);
         }
     }
-    
-    // filling output with all monitors except the target monitors
-    Json::Value val(Json::arrayValue);
-    for (auto& mon : m_outputs) {
-        bool is_target = std::any_of(target_monitors.begin(), target_monitors.end(), [&mon](const std::string& target) {
-            return mon.name == target;
-        });
-        
-        if (!is_target) {
-            val.append(mon.name);
-        } else {
-            mon.hidden = true;
-        }
-    }
-    setOutputs(val);
-    reloadPid();
-}
-
-auto Waybar::runCustomModeLoop() -> void {
-    auto [mouse_x, mouse_y] = initializeCustomModeMouse();
-
-    while (!g_interrupt_request.load(std::memory_order_acquire)) {
-        // Check for workspace changes
-        if (checkWorkspaceChange()) {
-            handleWorkspaceChange();
-        }
-        
-        bool need_reload = processCustomModeIteration(mouse_x, mouse_y);
-        requestApplyVisibleMonitors(need_reload);
-        std::this_thread::sleep_for(Constants::POLLING_INTERVAL);
-        std::tie(mouse_x, mouse_y) = getCursorPos();
-    }
-}
-
-auto Waybar::initializeCustomModeMouse() -> std::pair<int, int> {
-    return getCursorPos();
+    return target_monitors;
 }
 
-auto Waybar::processCustomModeIteration(int mouse_x, int mouse_y) -> bool {
-    bool need_reload = false;
-    
-    // Parse comma-separated monitor names
-    std::vector<std::string> target_monitors;
-    std::stringstream ss(m_hidemon);
-    std::string monitor;
-    
-    while (std::getline(ss, monitor, ',')) {
-        // Trim whitespace
-        monitor.erase(0, monitor.find_first_not_of(" \t"));
-        monitor.erase(monitor.find_last_not_of(" \t") + 1);
-        if (!monitor.empty()) {
-            target_monitors.push_back(monitor);
-        }
-    }
-    
-    // Process each target monitor
-    for (const auto& target_monitor : target_monitors) {
-        auto& mon = getMonitor(target_monitor);
-        const bool in_target_mon = is_cursor_in_monitor(mon, mouse_x, mouse_y);
-        const int local_bar_threshold = mon.y_coord + m_bar_threshold;
-
-        if (in_target_mon && !mon.hidden) {
-            need_reload |= handleMonitorThreshold(mon, mouse_x, mouse_y, local_bar_threshold);
-        } 
-        else if (in_target_mon && mon.hidden && mouse_y < mon.y_coord + Constants::MOUSE_ACTIVATION_ZONE) {
-            need_reload |= showHiddenMonitor(mon);
-        }
-    }
-
-    return need_reload;
-}
-
-auto Waybar::showHiddenMonitor(monitor_info_t& mon) -> bool {
-    if (m_verbose_level >= 1) {
-        log_message(LOG, "Mon: {} needs to be shown.\n", mon.name);
+auto Waybar::hideCustom() -> void {
+    if (m_outputs.size() <= Constants::SINGLE_MONITOR_THRESHOLD) {
+        log_message(WARN, "The number of monitors is {}. Fall back to `mode` ALL\n", m_outputs.size());
+        hideAllMonitors();
+        return;
     }
-    mon.hidden = false;
-    return true;
-}
 
-auto Waybar::cleanupCustomMode() -> void {
-    log_message(LOG, "Restoring original config.\n");
-    restoreOriginal();
-    reloadPid();
-    cleanupSignals();
+    setupCustomMode();
+    runVisibilityLoop();
+    cleanupCustomMode();
 }
 
-auto Waybar::handleMonitorThreshold(monitor_info_t& mon, int& mouse_x, int& mouse_y, int local_bar_threshold) -> bool {
-    if (mouse_y > local_bar_threshold) {
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Mon: {} needs to be hidden.\n", mon.name);
-        }
-        mon.hidden = true;
-        return true;
-    }
-    
-    // Keep showing while inside threshold
-    while (mouse_y <= local_bar_threshold && !g_interrupt_request.load(std::memory_order_acquire)) {
-        std::this_thread::sleep_for(Constants::POLLING_INTERVAL);
-        std::tie(mouse_x, mouse_y) = getCursorPos();
-    }
-    
-    if (m_verbose_level >= 1) {
-        log_message(LOG, "Mon: {} needs to be hidden.\n", mon.name);
-    }
-    mon.hidden = true;
-    return true;
+auto Waybar::setupCustomMode() -> void {
+    // target monitors start hidden, the others keep their bar
+    precomputeConfigVariants();
+    m_hidden = m_zones.targets;
+    writeVisibleMonitors();
+    setupSlots({.per_monitor = true, .targets_only = true, .arm_delay = 0ms, .hide_delay = Constants::BAR_HIDE_DELAY});
 }
 
-
+auto Waybar::cleanupCustomMode() -> void {
+    logReloadStats();
+    logConfigWriteStats();
+    log_message(LOG, "Restoring original config.\n");
+    restoreOriginal();
+    reloadPid();
+}
 
 auto Waybar::initConfig() -> void {
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    if (!runtime_dir) {
+        throw std::runtime_error("XDG_RUNTIME_DIR environment variable not set");
+    }
+    m_variant_dir = std::string(runtime_dir) + "/autowaybar";
     m_config_path = findConfigPath();
     loadConfig();
     validateConfig();
+    prepareConfigVariants();
+    watchConfig();
 }
 
 auto Waybar::findConfigPath() -> std::string {
@@ -765,7 +811,7 @@ auto Waybar::findConfigPath() -> std::string {
 }
 
 auto Waybar::loadConfig() -> void {
-    std::ifstream file(m_config_path);
+    std::ifstream file(m_config_path, std::ios::binary);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open config file: " + m_config_path);
     }
@@ -780,26 +826,71 @@ auto Waybar::loadConfig() -> void {
         throw std::runtime_error("Config file too large: " + std::to_string(file_size) + " bytes");
     }
     
-    Json::CharReaderBuilder builder;
-    // Set parsing limits
-    builder["maxDepth"] = 10;  // Maximum nesting depth
-    builder["maxErrors"] = 10; // Maximum parsing errors
-    
-    std::string errors;
-    if (!Json::parseFromStream(builder, file, &m_config, &errors)) {
-        throw std::runtime_error("Invalid JSON in config file: " + errors);
-    }
-    
-    m_backup = m_config;
-    log_message(LOG, "Backuping original config.\n");
+    m_config_text.resize(static_cast<size_t>(file_size));
+    file.read(m_config_text.data(), file_size);
+    log_message(LOG, "Read original config ({} bytes).\n", m_config_text.size());
 }
 
+// Checks the raw text with the pull parser, only top-level keys are looked
+// at, and records where the output value sits for setOutputs
 auto Waybar::validateConfig() -> void {
-    if (m_config.isArray()) {
+    JsonPull json(m_config_text, true);
+    JsonPull::Token token = json.next();
+    if (token == JsonPull::Token::BeginArray) {
         log_message(CRIT, "Multiple bars are not supported.\n");
         throw std::runtime_error("Multiple bars are not supported");
     }
-    if (!m_config.isMember("output")) {
+    
+    bool has_output = false;
+    m_config_has_members = false;
+    m_start_hidden_span = {};
+    if (token == JsonPull::Token::BeginObject) {
+        m_config_body = json.offset();
+        while ((token = json.next()) == JsonPull::Token::Key) {
+            m_config_has_members = true;
+            if (json.text() == "include") {
+                log_message(WARN, "Config uses \"include\": relative paths resolve from {} while autowaybar runs\n", m_variant_dir);
+            }
+            if (json.text() == "start_hidden") {
+                config_span_t span{.begin = json.offset()};
+                if (!json.skipValue()) break;
+                span.end = json.offset();
+                m_start_hidden_span = span; // the standby copy overwrites the last one
+                continue;
+            }
+            if (json.text() != "output") {
+                if (!json.skipValue()) break;
+                continue;
+            }
+            // the value's first token gives its start, counting stops at its end
+            has_output = true;
+            config_span_t span;
+            int depth = 0;
+            do {
+                JsonPull::Token value = json.next();
+                if (depth == 0) {
+                    span.begin = json.tokenBegin();
+                    span.null = value == JsonPull::Token::Null;
+                    span.entries = value == JsonPull::Token::BeginArray ? 0 : -1;
+                } else if (span.entries >= 0 && depth == 1 && value != JsonPull::Token::EndArray) {
+                    ++span.entries;
+                }
+                if (value == JsonPull::Token::BeginArray || value == JsonPull::Token::BeginObject) {
+                    ++depth;
+                } else if (value == JsonPull::Token::EndArray || value == JsonPull::Token::EndObject) {
+                    --depth;
+                } else if (value == JsonPull::Token::Error || value == JsonPull::Token::End) {
+                    break;
+                }
+            } while (depth > 0);
+            span.end = json.offset();
+            m_output_span = span; // a repeated key wins, like in waybar
+        }
+    }
+    if (token != JsonPull::Token::EndObject) {
+        throw std::runtime_error("Invalid JSON in config file near offset " + std::to_string(json.offset()));
+    }
+    if (!has_output && m_original_mode != BarMode::HIDE_ALL) {
         log_message(CRIT, "Config file does not contain 'output' field.\n");
         throw std::runtime_error("Config file does not contain 'output' field");
     }
@@ -832,27 +923,29 @@ auto Waybar::isValidConfigPath(const std::string& path) const -> bool {
     return false;
 }
 
+// Runs before initPidOrRestart replaces the user's waybar, so the config it
+// was started with can still be read from its command line
 auto Waybar::getConfigPath() -> std::string {
-    auto str_cmd = get_process_args(m_waybar_pid);
-    std::string_view cmd_view(str_cmd);
-    auto config_pos = cmd_view.find("-c");
-    
-    if (config_pos != std::string_view::npos) {
-        // Find the next argument after -c
-        auto start = config_pos + 2;
-        while (start < cmd_view.length() && std::isspace(cmd_view[start])) ++start;
-        
-        auto end = start;
-        while (end < cmd_view.length() && !std::isspace(cmd_view[end])) ++end;
-        
-        if (start < end) {
-            std::string config_path(cmd_view.substr(start, end - start));
-            
+    process_list_t running;
+    find_processes("waybar", running);
+    for (pid_t pid : running) {
+        // waybar accepts -c PATH, -cPATH, --config PATH and --config=PATH
+        auto args = get_process_args(pid);
+        for (size_t i = 1; i < args.size(); ++i) {
+            std::string_view arg(args[i]);
+            std::string config_path;
+            if (arg == "-c" || arg == "--config") {
+                if (i + 1 < args.size()) config_path = args[i + 1];
+            } else if (arg.starts_with("--config=")) {
+                config_path = arg.substr(9);
+            } else if (arg.starts_with("-c")) {
+                config_path = arg.substr(2);
+            }
+            if (config_path.empty()) continue;
+
             // Validate path is within expected directories
-            if (isValidConfigPath(config_path)) {
-                if (fs::exists(config_path)) {
-                    return config_path;
-                }
+            if (isValidConfigPath(config_path) && fs::exists(config_path)) {
+                return config_path;
             }
         }
     }
@@ -864,232 +957,327 @@ auto Waybar::getConfigPath() -> std::string {
     return {};
 }
 
-auto Waybar::getOutputs() -> Json::Value& {
-    return m_config["output"];
+auto Waybar::configVariantPath(std::uint32_t hidden) const -> std::string {
+    return fmt::format("{}/config-{:08x}", m_variant_dir, hidden);
 }
 
-auto Waybar::setOutputs(const Json::Value &outputs) -> void {
-    m_config["output"] = outputs;
-    saveConfig();
+// Waybar is started with -c on a symlink in the runtime dir (tmpfs). Every
+// visibility state gets its own copy of the user's config with a different
+// output value; switching is a symlink swap and SIGUSR2, and the user's file
+// is never written. Leftovers from a crashed run are cleared first. Until the
+// monitors are known the link points at the user's config itself.
+auto Waybar::prepareConfigVariants() -> void {
+    std::error_code ec;
+    fs::remove_all(m_variant_dir, ec);
+    if (mkdir(m_variant_dir.c_str(), 0700) == -1) {
+        throw std::runtime_error("Cannot create " + m_variant_dir + ": " + strerror(errno));
+    }
+    m_variant_link = m_variant_dir + "/config";
+    m_variants.clear();
+    replace_symlink(m_config_path, m_variant_link);
 }
 
-auto Waybar::saveConfig() -> void {
-    std::ofstream file(m_config_path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot write config file: " + m_config_path);
+// focused mode mostly has nothing or one monitor hidden; mon:<names> hides
+// any subset of its targets and nothing else
+auto Waybar::precomputeConfigVariants() -> void {
+    if (m_use_pool || m_hypr_commands.enabled()) {
+        return; // every instance keeps its own single-output config, or waybar keeps the user's
+    }
+    std::vector<std::uint32_t> expected{0};
+    if (m_original_mode == BarMode::HIDE_MON) {
+        const auto targets = static_cast<std::uint32_t>(m_zones.targets.to_ulong());
+        for (std::uint32_t subset = targets; subset != 0 && expected.size() < Constants::MAX_PRECOMPUTED_VARIANTS;
+             subset = (subset - 1) & targets) {
+            expected.push_back(subset);
+        }
+    } else {
+        for (size_t i = 0; i < m_outputs.size() && expected.size() < Constants::MAX_PRECOMPUTED_VARIANTS; ++i) {
+            expected.push_back(std::uint32_t{1} << i);
+        }
+    }
+    for (auto hidden : expected) {
+        writeConfigVariant(hidden);
+    }
+    if (m_verbose_level >= 1) {
+        log_message(LOG, "{} config variants ready in {}\n", m_variants.size(), m_variant_dir);
     }
-    
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "  ";
-    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-    writer->write(m_config, &file);
 }
 
-auto Waybar::restoreOriginal() -> void {
-    if (m_config_path.empty()) {
-        log_message(WARN, "No config path available for restoration - waybar may not have been started properly\n");
+// Splices the output value for this hidden set into the original text; the
+// rest of the file goes out byte for byte from m_config_text
+auto Waybar::writeConfigVariant(std::uint32_t hidden) -> void {
+    if (std::find(m_variants.cbegin(), m_variants.cend(), hidden) != m_variants.cend()) {
         return;
     }
-    
-    std::ofstream file(m_config_path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot write config file: " + m_config_path + " (check permissions and path)");
+    std::string_view text(m_config_text);
+    size_t written = replace_file(configVariantPath(hidden), {
+        text.substr(0, m_output_span.begin),
+        renderOutputs(hot_zone_table_t::monitor_set_t(hidden)),
+        text.substr(m_output_span.end),
+    });
+    m_variants.push_back(hidden);
+    ++m_config_writes.writes;
+    m_config_writes.file_bytes += written;
+}
+
+auto Waybar::selectConfigVariant() -> void {
+    const auto hidden = static_cast<std::uint32_t>(m_hidden.to_ulong());
+    writeConfigVariant(hidden);
+    replace_symlink(configVariantPath(hidden), m_variant_link);
+    ++m_config_writes.switches;
+}
+
+// Editors replace the file (write a temp, rename it over), so the directory
+// is watched rather than the inode. A dotfiles symlink adds the directory of
+// the real file. We never write there ourselves, so every event is an edit;
+// unchanged bytes (a touch, a save without changes) are ignored on re-read.
+auto Waybar::watchConfig() -> void {
+    m_config_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_config_watch_fd == -1) {
+        log_message(WARN, "Cannot watch the waybar config: {}\n", strerror(errno));
+        return;
     }
-    
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "  ";
-    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-    writer->write(m_backup, &file);
-}
-
-auto Waybar::hideAllMonitors(bool is_visible) -> void {
-    setupAllMonitorsMode(is_visible);
-    runAllMonitorsLoop(is_visible);
-    cleanupAllMonitorsMode();
-}
 
-auto Waybar::setupAllMonitorsMode(bool& is_visible) -> void {
-    if (is_visible) {
-        hideWaybar();
-        is_visible = false;
+    std::error_code ec;
+    const fs::path link(m_config_path);
+    const fs::path target = fs::canonical(link, ec);
+    constexpr auto mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM;
+    for (const auto& path : {link, target}) {
+        if (path.empty()) continue;
+        inotify_add_watch(m_config_watch_fd, path.parent_path().c_str(), mask);
+        m_config_watch_names.push_back(path.filename().string());
     }
-}
 
-auto Waybar::cleanupAllMonitorsMode() -> void {
-    reloadPid();
+    m_config_settle_timer = m_loop.addTimer([this] { reloadChangedConfig(); });
+    m_loop.watch(m_config_watch_fd, [this] { readConfigEvents(); });
 }
 
-auto Waybar::runAllMonitorsLoop(bool is_visible) -> void {
-    while (!g_interrupt_request.load(std::memory_order_acquire)) {
-        auto [root_x, root_y] = getCursorPos();
-        if (m_is_console and m_verbose_level >= 2)
-            log_message(TRACE, "Mouse at position ({},{})\n", root_x, root_y);
-        
-        // Check for workspace changes
-        if (checkWorkspaceChange()) {
-            handleWorkspaceChange();
+auto Waybar::readConfigEvents() -> void {
+    alignas(inotify_event) std::array<char, 4096> buf;
+    bool touched = false;
+    ssize_t len;
+    while ((len = read(m_config_watch_fd, buf.data(), buf.size())) > 0) {
+        for (ssize_t pos = 0; pos < len;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buf.data() + pos);
+            pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            if (event->len == 0) continue;
+            std::string_view name(event->name);
+            touched |= std::find(m_config_watch_names.cbegin(), m_config_watch_names.cend(), name) != m_config_watch_names.cend();
         }
-        
-        is_visible = processAllMonitorsVisibility(root_x, root_y, is_visible);
-        std::this_thread::sleep_for(Constants::POLLING_INTERVAL);
     }
-}
-
-auto Waybar::processAllMonitorsVisibility(int /* root_x */, int root_y, bool is_visible) -> bool {
-    for (auto &mon : m_outputs) {
-        is_visible = processMonitorVisibility(mon, root_y, is_visible);
+    if (touched) {
+        m_loop.armTimer(m_config_settle_timer, std::chrono::steady_clock::now() + Constants::CONFIG_SETTLE_DELAY);
     }
-    return is_visible;
 }
 
-auto Waybar::processMonitorVisibility(const monitor_info_t& mon, int root_y, bool is_visible) -> bool {
-    // Don't process normal visibility logic if we're handling a workspace change
-    if (g_handling_workspace_change.load(std::memory_order_acquire)) {
+// The pull parser re-scans the new text (one pass, no DOM); only variants
+// are regenerated, waybar picks them up on its next reload like it would
+// have picked up the edit without us. A half-saved or invalid file keeps
+// the previous text.
+auto Waybar::reloadChangedConfig() -> void {
+    std::string previous_text = std::move(m_config_text);
+    const config_span_t previous_span = m_output_span;
+    const config_span_t previous_start_hidden = m_start_hidden_span;
+    const size_t previous_body = m_config_body;
+    const bool previous_members = m_config_has_members;
+    try {
+        loadConfig();
+        validateConfig();
+    } catch (const std::exception& e) {
+        log_message(WARN, "Ignoring waybar config change: {}\n", e.what());
+        m_config_text = std::move(previous_text);
+        m_output_span = previous_span;
+        m_start_hidden_span = previous_start_hidden;
+        m_config_body = previous_body;
+        m_config_has_members = previous_members;
+        return;
+    }
+    if (m_config_text == previous_text) {
         if (m_verbose_level >= 2) {
-            log_message(TRACE, "Skipping normal visibility logic - workspace change in progress\n");
+            log_message(TRACE, "Waybar config touched but unchanged\n");
         }
-        return is_visible; // Keep current state
+        return;
     }
-    
-    const int local_bar_threshold = mon.y_coord + m_bar_threshold;
-    
-    if (!is_visible && shouldShowWaybar(mon, root_y)) {
-        // Mouse is in activation zone - start or continue tracking
-        if (!m_mouse_in_activation_zone) {
-            m_mouse_in_activation_zone = true;
-            m_mouse_activation_start = std::chrono::steady_clock::now();
-        }
-        
-        // Check if mouse has been in activation zone long enough
-        if (checkMouseActivationDelay()) {
-            return showWaybarAndKeepOpen(mon, local_bar_threshold);
+
+    logToFile("Waybar config changed on disk, regenerating variants\n");
+    log_message(INFO, "Waybar config changed on disk, regenerating variants\n");
+    if (m_use_pool) {
+        // nothing else reloads the instances, and a reload would show a
+        // hidden bar, so those wait until they are shown anyway
+        for (size_t i = 0; i < m_waybars.size(); ++i) {
+            writeOutputConfig(m_waybars[i].output);
+            postIntent(i, WaybarIntent::Reload);
         }
+        return;
     }
-    else if (is_visible && shouldHideWaybar(mon, root_y, local_bar_threshold)) {
-        return hideWaybarAndReturnFalse();
+    auto written = std::exchange(m_variants, {});
+    for (auto hidden : written) {
+        writeConfigVariant(hidden);
     }
-    else {
-        // Mouse is not in activation zone - reset tracking
-        m_mouse_in_activation_zone = false;
+}
+
+auto Waybar::removeConfigVariants() -> void {
+    if (m_variant_dir.empty()) {
+        return;
     }
-    
-    return is_visible;
+    std::error_code ec;
+    fs::remove_all(m_variant_dir, ec);
 }
 
-auto Waybar::showWaybarAndKeepOpen(const monitor_info_t& /* mon */, int local_bar_threshold) -> bool {
-    showWaybar();
-    auto [root_x, root_y] = getCursorPos();
-    while (root_y < local_bar_threshold && !g_interrupt_request.load(std::memory_order_acquire)) {
-        std::this_thread::sleep_for(Constants::POLLING_INTERVAL);
-        std::tie(root_x, root_y) = getCursorPos();
+auto Waybar::logConfigWriteStats() const -> void {
+    if (m_verbose_level < 1 || m_config_writes.switches == 0) {
+        return;
     }
-    return true;
+    const auto& stats = m_config_writes;
+    log_message(LOG, "Config: {} switches served by {} variants ({} bytes written to {}, none to the user's config)\n",
+               stats.switches, stats.writes, stats.file_bytes, m_variant_dir);
 }
 
-auto Waybar::hideWaybarAndReturnFalse() -> bool {
-    hideWaybar();
-    return false;
+// The user's config was never touched; a waybar that reloads now reads it again
+auto Waybar::restoreOriginal() -> void {
+    if (m_hypr_commands.enabled() && !m_hypr_hidden.empty()) {
+        sendHyprCommands(true);
+    }
+    if (m_config_path.empty()) {
+        log_message(WARN, "No config path available for restoration - waybar may not have been started properly\n");
+        return;
+    }
+    if (m_variant_link.empty()) {
+        return;
+    }
+    
+    replace_symlink(m_config_path, m_variant_link);
 }
 
-auto Waybar::shouldShowWaybar(const monitor_info_t& mon, int root_y) const -> bool {
-    return mon.y_coord <= root_y && root_y < mon.y_coord + Constants::MOUSE_ACTIVATION_ZONE;
+auto Waybar::hideAllMonitors() -> void {
+    setupAllMonitorsMode();
+    runVisibilityLoop();
+    cleanupAllMonitorsMode();
 }
 
-auto Waybar::shouldHideWaybar(const monitor_info_t& mon, int root_y, int threshold) const -> bool {
-    return root_y < mon.y_coord + mon.height && root_y > threshold;
+auto Waybar::setupAllMonitorsMode() -> void {
+    hideWaybar();
+    setupSlots({.per_monitor = false, .targets_only = false,
+                .arm_delay = Constants::MOUSE_ACTIVATION_DELAY, .hide_delay = Constants::BAR_HIDE_DELAY});
 }
 
-auto Waybar::checkMouseActivationDelay() -> bool {
-    if (!m_mouse_in_activation_zone) {
-        return false;
-    }
-    
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = now - m_mouse_activation_start;
-    
-    return elapsed >= Constants::MOUSE_ACTIVATION_DELAY;
+auto Waybar::cleanupAllMonitorsMode() -> void {
+    reloadPid();
 }
 
 auto Waybar::showWaybar() -> void {
-    if (!m_waybar_visible) {
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Opening it. \n");
-        }
-        if (kill(m_waybar_pid, SIGUSR1) == -1) {
-            if (errno == ESRCH) {
-                // Process doesn't exist, try to restart waybar
-                log_message(WARN, "Waybar process {} not found, attempting restart...\n", m_waybar_pid);
-                m_waybar_pid = restartWaybar();
-                // Try again after restart
-                if (kill(m_waybar_pid, SIGUSR1) == -1) {
-                    throw std::runtime_error("Failed to send SIGUSR1 to restarted waybar process " + std::to_string(m_waybar_pid) + ": " + strerror(errno));
-                }
-            } else {
-                throw std::runtime_error("Failed to send SIGUSR1 to waybar process " + std::to_string(m_waybar_pid) + ": " + strerror(errno));
-            }
-        }
-        m_waybar_visible = true;
+    if (!m_waybars[0].visible) {
+        postIntent(0, WaybarIntent::Show);
     }
 }
 
 auto Waybar::hideWaybar() -> void {
-    if (m_waybar_visible) {
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Hiding it. \n");
-        }
-        if (kill(m_waybar_pid, SIGUSR1) == -1) {
-            if (errno == ESRCH) {
-                // Process doesn't exist, try to restart waybar
-                log_message(WARN, "Waybar process {} not found, attempting restart...\n", m_waybar_pid);
-                m_waybar_pid = restartWaybar();
-                // Try again after restart
-                if (kill(m_waybar_pid, SIGUSR1) == -1) {
-                    throw std::runtime_error("Failed to send SIGUSR1 to restarted waybar process " + std::to_string(m_waybar_pid) + ": " + strerror(errno));
-                }
-            } else {
-                throw std::runtime_error("Failed to send SIGUSR1 to waybar process " + std::to_string(m_waybar_pid) + ": " + strerror(errno));
-            }
-        }
-        m_waybar_visible = false;
+    if (m_waybars[0].visible) {
+        postIntent(0, WaybarIntent::Hide);
     }
 }
 
 
+// A waybar that is restarting reads the config when it comes up anyway.
+// Called by the loop's owner itself, on a variant switch and at shutdown.
 auto Waybar::reloadPid() -> void {
-    log_message(INFO, "Reloading PID: {}\n", m_waybar_pid);
-    
-    if (kill(m_waybar_pid, SIGUSR2) == -1) {
-        if (errno == ESRCH) {
-            // Process doesn't exist, try to restart waybar
-            log_message(WARN, "Waybar process {} not found, attempting restart...\n", m_waybar_pid);
-            m_waybar_pid = restartWaybar();
-        } else {
-            throw std::runtime_error("Failed to send SIGUSR2 to waybar process " + std::to_string(m_waybar_pid) + ": " + strerror(errno));
+    for (size_t i = 0; i < m_waybars.size(); ++i) {
+        if (m_waybars[i].phase != WaybarPhase::Running) {
+            continue;
         }
+        log_message(INFO, "Reloading PID: {}\n", m_waybars[i].pid);
+        m_waybars.signal(i, SIGUSR2);
     }
 }
 
-auto Waybar::shutdown() -> void {
-    log_message(INFO, "Shutting down waybar process (PID: {})\n", m_waybar_pid);
-    
-    // First try graceful termination with SIGTERM
-    if (kill(m_waybar_pid, SIGTERM) == -1) {
-        if (errno != ESRCH) {
-            log_message(WARN, "Failed to send SIGTERM to waybar process {}: {}\n", m_waybar_pid, strerror(errno));
-        }
+// SIGUSR1 toggles, so the state is tracked per instance; a stale one is
+// shown by the reload that picks up its new config. While an instance
+// restarts nothing is sent, handleWaybarUp asks again once it is up.
+auto Waybar::setWaybarVisible(size_t index, bool visible) -> bool {
+    auto& bar = m_waybars[index];
+    if (bar.visible == visible || !m_waybars.signal(index, visible && bar.stale ? SIGUSR2 : SIGUSR1)) {
+        return false;
+    }
+    bar.stale = false;
+    bar.visible = visible;
+    return true;
+}
+
+auto Waybar::handleWaybarUp(size_t index) -> void {
+    syncWaybar(index);
+}
+
+// The standby gets its own link, alternating between two names so the one
+// the active waybar was promoted on is never retargeted under it
+auto Waybar::prepareStandby(size_t index) -> std::string {
+    const auto& bar = m_waybars[index];
+    const std::string key = instanceConfigPath(bar);
+    const std::string hidden = key + ".hidden";
+    const std::string link = key + (bar.config == key + ".standby-0" ? ".standby-1" : ".standby-0");
+
+    // the user's own start_hidden gets its value replaced, otherwise the key goes first
+    struct splice_t {
+        size_t begin, end;
+        std::string_view text;
+    };
+    std::array<splice_t, 2> splices{};
+    size_t count = 0;
+    if (m_start_hidden_span.end != 0) {
+        splices[count++] = {m_start_hidden_span.begin, m_start_hidden_span.end, ": true"};
     } else {
-        // Wait for process to die gracefully
-        int attempts = 0;
-        while (kill(m_waybar_pid, 0) == 0 && attempts < 10) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            attempts++;
+        splices[count++] = {m_config_body, m_config_body,
+                            m_config_has_members ? "\"start_hidden\": true, " : "\"start_hidden\": true"};
+    }
+    if (!bar.output.empty()) {
+        m_outputs_text.assign("[");
+        appendJsonString(m_outputs_text, bar.output);
+        m_outputs_text.push_back(']');
+        splices[count++] = {m_output_span.begin, m_output_span.end, m_outputs_text};
+    }
+    std::sort(splices.begin(), splices.begin() + count, [](const splice_t& a, const splice_t& b) { return a.begin < b.begin; });
+
+    std::string_view text(m_config_text);
+    std::string content;
+    content.reserve(text.size() + 64);
+    size_t copied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        content.append(text.substr(copied, splices[i].begin - copied));
+        content.append(splices[i].text);
+        copied = splices[i].end;
+    }
+    content.append(text.substr(copied));
+    size_t written = replace_file(hidden, {content});
+    ++m_config_writes.writes;
+    m_config_writes.file_bytes += written;
+    replace_symlink(hidden, link);
+    return link;
+}
+
+// Chained through the variant link (or the pool instance's own config), so
+// later switches and config edits reach the promoted waybar on its next reload
+auto Waybar::promoteStandby(size_t index) -> void {
+    const auto& bar = m_waybars[index];
+    replace_symlink(instanceConfigPath(bar), bar.config);
+}
+
+auto Waybar::instanceConfigPath(const waybar_instance_t& bar) const -> std::string {
+    return bar.output.empty() ? m_variant_link : m_variant_dir + "/output-" + bar.output;
+}
+
+auto Waybar::shutdown() -> void {
+    m_waybars.stopAll();
+    if (m_verbose_level >= 1) {
+        m_waybars.logStats();
+        const auto& stats = m_intent_stats;
+        if (stats.intents > 0) {
+            log_message(LOG, "Intents: {} drained into {} waybar signals ({} queue overflows)\n",
+                       stats.intents, stats.signals, stats.overflows);
         }
-        
-        // Force kill if still running
-        if (kill(m_waybar_pid, 0) == 0) {
-            log_message(WARN, "Force killing waybar process {}\n", m_waybar_pid);
-            kill(m_waybar_pid, SIGKILL);
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto& predicted = m_predict_stats;
+        if (predicted.reveals > 0) {
+            log_message(LOG, "Prediction: {} early reveals, {} reached the zone, {} false ({}%)\n",
+                       predicted.reveals, predicted.confirmed, predicted.false_reveals,
+                       100 * predicted.false_reveals / predicted.reveals);
         }
     }
 }
@@ -1105,122 +1293,203 @@ auto Waybar::hideFocused() -> void {
     }
 
     setupFocusedMode();
-    runFocusedModeLoop();
+    runVisibilityLoop();
     cleanupFocusedMode();
 }
 
 auto Waybar::setupFocusedMode() -> void {
     validateFocusedModeConfig();
     std::sort(m_outputs.begin(), m_outputs.end());
+    rebuildZones();
+    m_variants.clear(); // the sort re-indexed the hidden sets
+    precomputeConfigVariants();
+    setupSlots({.per_monitor = true, .targets_only = false, .arm_delay = 0ms, .hide_delay = Constants::BAR_HIDE_DELAY});
 }
 
 auto Waybar::validateFocusedModeConfig() -> void {
-    if (auto &o = getOutputs();
-        !o.isNull() && o.size() < m_outputs.size()) {
+    const auto& span = m_output_span;
+    if (!span.null && (span.entries < 0 || static_cast<size_t>(span.entries) < m_outputs.size())) {
         log_message(LOG, "Some monitors are not in the Waybar config, adding all of them. \n");
-        Json::Value val;
-        for (const auto& mon : m_outputs)
-            val.append(mon.name);
-        setOutputs(val);
     }
 }
 
-auto Waybar::runFocusedModeLoop() -> void {
-    auto [mouse_x, mouse_y] = initializeMousePosition();
+auto Waybar::cleanupFocusedMode() -> void {
+    logReloadStats();
+    logConfigWriteStats();
+    log_message(LOG, "Restoring original config.\n");
+    restoreOriginal();
+    reloadPid();
+}
 
-    while (!g_interrupt_request.load(std::memory_order_acquire)) {
-        // Check for workspace changes
-        if (checkWorkspaceChange()) {
-            handleWorkspaceChange();
-        }
-        
-        bool need_reload = processFocusedMonitors(mouse_x, mouse_y);
-        applyChanges(need_reload);
-        sleepAndUpdateMouse(mouse_x, mouse_y);
+// Visibility state machine
+
+auto Waybar::setupSlots(const bar_policy_t& policy) -> void {
+    m_policy = policy;
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_policy.per_monitor) {
+        // setupAllMonitorsMode just hid it; a waybar still starting gets that from handleWaybarUp
+        m_slots.assign(1, bar_slot_t{.state = BarState::Hidden, .since = now});
+        return;
+    }
+    m_slots.assign(m_outputs.size(), bar_slot_t{});
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        m_slots[i] = {.state = m_hidden[i] ? BarState::Hidden : BarState::Shown, .since = now};
     }
 }
 
-auto Waybar::initializeMousePosition() -> std::pair<int, int> {
-    return getCursorPos();
+auto Waybar::slotFor(int mon) const -> int {
+    if (mon < 0) return -1;
+    if (!m_policy.per_monitor) return 0;
+    if (m_policy.targets_only && !m_zones.targets[mon]) return -1;
+    return static_cast<size_t>(mon) < m_slots.size() ? mon : -1;
 }
 
-auto Waybar::applyChanges(bool need_reload) -> void {
-    requestApplyVisibleMonitors(need_reload);
-}
+auto Waybar::runVisibilityLoop() -> void {
+    m_sampler.start(m_poll_interval);
+    HyprSnapshot snap = nextSample({});
 
-auto Waybar::sleepAndUpdateMouse(int& mouse_x, int& mouse_y) -> void {
-    std::this_thread::sleep_for(Constants::POLLING_INTERVAL);
-    std::tie(mouse_x, mouse_y) = getCursorPos();
-    if (m_is_console and m_verbose_level >= 2)
-        log_message(TRACE, "Mouse at position ({},{})\n", mouse_x, mouse_y);
-}
+    while (!g_interrupt_request.load(std::memory_order_acquire)) {
+        if (m_is_console and m_verbose_level >= 2)
+            log_message(TRACE, "Mouse at position ({},{})\n", snap.cursor_x, snap.cursor_y);
 
-auto Waybar::processFocusedMonitors(int mouse_x, int mouse_y) -> bool {
-    bool need_reload = false;
+        applyTopologyChanges();
+        if (m_trace.is_open()) {
+            recordTrace(snap);
+        }
 
-    for (auto& mon : m_outputs) {
-        if (isCursorInCurrentMonitor(mon, mouse_x, mouse_y)) {
-            need_reload |= processCurrentMonitor(mon, mouse_x, mouse_y);
+        if (checkWorkspaceChange(snap)) {
+            handleWorkspaceChange(snap);
         }
-    }
 
-    return need_reload;
-}
+        advanceVisibility(snap);
+        applyVisibility();
+        drainIntents(); // this tick's own intents go out now, not after the wait
+        m_sampler.setInterval(schedulePoll(snap));
+        snap = nextSample(snap);
+    }
+    m_sampler.stop();
+    m_trace.flush();
+}
+
+// One step for every slot: the slot under the cursor sees the zone and the
+// threshold of that monitor, the others can only leave Arming or let a
+// workspace reveal expire. Delays are compared against the sample time, so a
+// late tick never waits and a zero delay passes in the same tick. With
+// --predict a hidden bar may skip ahead to Shown, held like a workspace
+// reveal so the threshold does not take it back before the cursor arrives.
+auto Waybar::advanceVisibility(const HyprSnapshot& snap) -> void {
+    const auto now = snap.taken_at;
+    const int mon = m_zones.monitorAt(snap.cursor_x, snap.cursor_y);
+    const int cursor_slot = slotFor(mon);
+    const bool predicted = m_predict && m_predictor.update(now, mon, mon < 0 ? 0 : std::max(0, snap.cursor_y - (m_zones.zone_end[mon] - 1)));
+
+    for (int slot = 0; slot < static_cast<int>(m_slots.size()); ++slot) {
+        auto& bar = m_slots[slot];
+        const bool under_cursor = slot == cursor_slot;
+        const bool in_zone = under_cursor && m_zones.top[mon] <= snap.cursor_y && snap.cursor_y < m_zones.zone_end[mon];
+
+        if (under_cursor && predicted && !bar.visible()) {
+            fireBarEvent(slot, BarEvent::Predicted, now);
+            bar.predicted = true;
+            bar.hold_until = std::max(bar.hold_until, now + m_predictor.config().hold);
+            m_loop.armTimer(m_predict_hold_timer, bar.hold_until);
+            ++m_predict_stats.reveals;
+            if (m_verbose_level >= 1) {
+                log_message(LOG, "Predicted reveal at y={} ({:.1f}px/ms)\n", snap.cursor_y, m_predictor.velocity());
+            }
+        }
+        if (bar.predicted && in_zone) {
+            bar.predicted = false;
+            ++m_predict_stats.confirmed;
+        }
 
-auto Waybar::isCursorInCurrentMonitor(const monitor_info_t& mon, int mouse_x, int mouse_y) -> bool {
-    return is_cursor_in_monitor(mon, mouse_x, mouse_y);
-}
+        fireBarEvent(slot, in_zone ? BarEvent::EnterZone : BarEvent::LeaveZone, now);
+        if (bar.state == BarState::Arming && now - bar.since >= m_policy.arm_delay) {
+            fireBarEvent(slot, BarEvent::ArmElapsed, now);
+        }
 
-auto Waybar::processCurrentMonitor(monitor_info_t& mon, int mouse_x, int mouse_y) -> bool {
-    // Don't process normal visibility logic if we're handling a workspace change
-    if (g_handling_workspace_change.load(std::memory_order_acquire)) {
-        if (m_verbose_level >= 2) {
-            log_message(TRACE, "Skipping focused mode logic - workspace change in progress\n");
+        const bool held = bar.hold_until > now;
+        if (!held && bar.hold_until != std::chrono::steady_clock::time_point{}) {
+            bar.hold_until = {};
+            if (bar.predicted) {
+                bar.predicted = false;
+                ++m_predict_stats.false_reveals;
+            }
+            fireBarEvent(slot, BarEvent::HoldElapsed, now);
+        }
+        if (!held) {
+            const bool past = under_cursor ? snap.cursor_y > m_zones.threshold[mon] : bar.state == BarState::Hiding;
+            fireBarEvent(slot, past ? BarEvent::PastThreshold : BarEvent::WithinThreshold, now);
+        }
+        if (bar.state == BarState::Hiding && now - bar.since >= m_policy.hide_delay) {
+            fireBarEvent(slot, BarEvent::HideElapsed, now);
         }
-        return false; // No changes needed
-    }
-    
-    if (!mon.hidden) {
-        return handleVisibleMonitor(mon, mouse_x, mouse_y);
-    } else {
-        return handleHiddenMonitor(mon, mouse_x, mouse_y);
     }
 }
 
-auto Waybar::handleVisibleMonitor(monitor_info_t& mon, int mouse_x, int mouse_y) -> bool {
-    const int local_bar_threshold = mon.y_coord + m_bar_threshold;
-    return handleMonitorThreshold(mon, mouse_x, mouse_y, local_bar_threshold);
-}
-
-auto Waybar::handleHiddenMonitor(monitor_info_t& mon, int /* mouse_x */, int mouse_y) -> bool {
-    if (mouse_y < mon.y_coord + Constants::MOUSE_ACTIVATION_ZONE) {
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Mon: {} needs to be shown.\n", mon.name);
+auto Waybar::fireBarEvent(int slot, BarEvent event, std::chrono::steady_clock::time_point now) -> void {
+    auto& bar = m_slots[slot];
+    for (const auto& transition : BAR_TRANSITIONS) {
+        if (transition.from != bar.state || transition.event != event) continue;
+        if (m_verbose_level >= 2) {
+            log_message(TRACE, "Bar {}: {} -> {}\n", m_policy.per_monitor ? m_outputs[slot].name : "all",
+                       barStateName(bar.state), barStateName(transition.to));
         }
-        mon.hidden = false;
-        return true;
+        bar.state = transition.to;
+        bar.since = now;
+        return;
     }
-    return false;
 }
 
-auto Waybar::cleanupFocusedMode() -> void {
-    log_message(LOG, "Restoring original config.\n");
-    restoreOriginal();
-    reloadPid();
-    cleanupSignals();
+// Times are relative to the first recorded sample; zone_edge is the last row
+// of the activation zone on the cursor's monitor, -1 off every monitor
+auto Waybar::recordTrace(const HyprSnapshot& snap) -> void {
+    if (m_trace_start == std::chrono::steady_clock::time_point{}) {
+        m_trace_start = snap.taken_at;
+    }
+    const int mon = m_zones.monitorAt(snap.cursor_x, snap.cursor_y);
+    m_trace << std::chrono::duration_cast<std::chrono::microseconds>(snap.taken_at - m_trace_start).count() << ' '
+            << snap.cursor_x << ' ' << snap.cursor_y << ' ' << mon << ' '
+            << (mon < 0 ? -1 : m_zones.zone_end[mon] - 1) << '\n';
 }
 
-auto Waybar::getMonitor(const std::string &name) -> monitor_info_t& {
-    for (auto& mon : m_outputs) {
-        if (mon.name == name) {
-            return mon;
+// Only the edges reach waybar: SIGUSR1 toggles the single bar, per-monitor
+// bars go through the outputs diff of requestApplyVisibleMonitors
+auto Waybar::applyVisibility() -> void {
+    if (!m_policy.per_monitor) {
+        if (m_slots[0].visible()) {
+            showWaybar();
+        } else {
+            hideWaybar();
         }
+        return;
     }
 
-    throw std::invalid_argument("Monitor '" + name + "' not found");
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        const bool hidden = !m_slots[i].visible();
+        if (hidden != m_hidden[i] && m_verbose_level >= 1) {
+            log_message(LOG, "Mon: {} needs to be {}.\n", m_outputs[i].name, hidden ? "hidden" : "shown");
+        }
+        m_hidden[i] = hidden;
+    }
+    requestApplyVisibleMonitors(true);
 }
 
 // Workspace monitoring functions
+
+// One IPC round trip per tick. Without the socket we fall back to hyprctl,
+// and skip the workspace query when socket2 is tracking it anyway.
+auto Waybar::takeSnapshot() const -> HyprSnapshot {
+    HyprSnapshot snap;
+    snap.taken_at = std::chrono::steady_clock::now();
+    if (getHyprSnapshot(snap)) {
+        return snap;
+    }
+    std::tie(snap.cursor_x, snap.cursor_y) = getCursorPos();
+    snap.workspace = m_events_live.load(std::memory_order_acquire) ? g_current_workspace.load(std::memory_order_acquire) : getCurrentWorkspace();
+    return snap;
+}
+
 auto Waybar::getCurrentWorkspace() const -> int {
     if (!isHyprlandRunning()) {
         return 1; // fallback to workspace 1
@@ -1248,88 +1517,282 @@ auto Waybar::getCurrentWorkspace() const -> int {
     return 1; // fallback
 }
 
-auto Waybar::checkWorkspaceChange() const -> bool {
-    // Don't check for workspace changes if we're already handling one
-    if (g_handling_workspace_change.load(std::memory_order_acquire)) {
-        if (m_verbose_level >= 2) {
-            log_message(TRACE, "Skipping workspace check - already handling change\n");
-        }
-        return false;
-    }
-    
-    // Debouncing: don't check for workspace changes too frequently
-    auto now = std::chrono::steady_clock::now();
-    auto last_change = g_last_workspace_change.load(std::memory_order_acquire);
-    if (now - last_change < std::chrono::milliseconds(500)) {
-        if (m_verbose_level >= 2) {
-            log_message(TRACE, "Skipping workspace check - too soon after last change\n");
-        }
-        return false;
+auto Waybar::checkWorkspaceChange(const HyprSnapshot& snap) -> bool {
+    // Event driven: socket2 already told us
+    if (std::exchange(m_workspace_event, false)) {
+        return true;
     }
     
-    int current_workspace = getCurrentWorkspace();
     int previous_workspace = g_current_workspace.load(std::memory_order_acquire);
     
     if (m_verbose_level >= 2) {
-        log_message(TRACE, "Workspace check: current={}, previous={}\n", current_workspace, previous_workspace);
+        log_message(TRACE, "Workspace check: current={} on {}, previous={}\n",
+                   snap.workspace, snap.monitorName(), previous_workspace);
     }
     
-    if (current_workspace != previous_workspace) {
-        g_current_workspace.store(current_workspace, std::memory_order_release);
-        g_last_workspace_change.store(now, std::memory_order_release);
+    if (snap.workspace != previous_workspace) {
+        g_current_workspace.store(snap.workspace, std::memory_order_release);
         if (m_verbose_level >= 1) {
-            log_message(LOG, "Workspace change detected: {} -> {}\n", previous_workspace, current_workspace);
+            log_message(LOG, "Workspace change detected: {} -> {} on {}\n",
+                       previous_workspace, snap.workspace, snap.monitorName());
         }
         return true; // workspace changed
     }
     return false; // no change
 }
 
-auto Waybar::handleWorkspaceChange() -> void {
+// Reveals the bar of the monitor that switched workspace (the only bar in
+// HIDE_ALL) for WORKSPACE_SHOW_DURATION, then the cursor decides again.
+auto Waybar::handleWorkspaceChange(const HyprSnapshot& snap) -> void {
     static int handle_count = 0;
     handle_count++;
     
-    auto now = std::chrono::steady_clock::now();
+    auto now = snap.taken_at;
     int current_workspace = g_current_workspace.load(std::memory_order_acquire);
     
     if (m_verbose_level >= 1) {
         log_message(LOG, "handleWorkspaceChange() #{} - workspace changed to workspace {}\n", handle_count, current_workspace);
     }
-    
-    // Always update the show start time and show waybar for new workspace changes
-    g_workspace_show_start.store(now, std::memory_order_release);
-    showWaybar();
-    
-    // Start the hide timer
-    int local_handle_count = handle_count; // Make local copy to avoid capturing static variable
-    std::thread([this, local_handle_count, show_start_time = now]() {
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Thread #{} starting 1-second delay\n", local_handle_count);
+
+    int mon = -1;
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+        if (m_outputs[i].name == snap.monitorName()) mon = static_cast<int>(i);
+    }
+    const int cursor_slot = slotFor(m_zones.monitorAt(snap.cursor_x, snap.cursor_y));
+    const int slot = mon >= 0 ? slotFor(mon) : cursor_slot;
+    if (slot < 0) return;
+
+    // a bar shown away from the cursor stays up on its own, a hold would hide it
+    auto& bar = m_slots[slot];
+    if (slot != cursor_slot && bar.visible() && bar.hold_until == std::chrono::steady_clock::time_point{}) {
+        return;
+    }
+    fireBarEvent(slot, BarEvent::Reveal, now);
+    // a newer switch just moves the deadline
+    bar.hold_until = now + Constants::WORKSPACE_SHOW_DURATION;
+    m_loop.armTimer(m_workspace_hide_timer, bar.hold_until);
+}
+
+// Waits in the event loop for the sampler thread, which keeps its own
+// absolute schedule. Only the newest queued sample is used; a backlog means
+// the loop fell behind and the older ones are counted as skipped. When the
+// ring overflowed, the sampler threw away samples newer than anything still
+// queued, so a fresh one is requested instead. A workspace switch, a hotplug
+// or an expired reveal also asks for a sample right away, and anything taken
+// before that is skipped so the tick never reacts with a cursor from before
+// the event. Returns the last sample on a signal.
+auto Waybar::nextSample(const HyprSnapshot& last) -> HyprSnapshot {
+    auto fresh_after = std::chrono::steady_clock::time_point{};
+    cursor_sample_t sample, newest;
+    while (!g_interrupt_request.load(std::memory_order_acquire)) {
+        bool popped = false;
+        while (m_sampler.pop(sample)) {
+            m_samples_skipped += popped;
+            newest = sample;
+            popped = true;
         }
-        
-        // Wait for the specified duration
-        std::this_thread::sleep_for(Constants::WORKSPACE_SHOW_DURATION);
-        
-        // Check if this is still the most recent workspace change
-        auto current_show_start = g_workspace_show_start.load(std::memory_order_acquire);
-        if (current_show_start != show_start_time) {
+        if (const int dropped = m_sampler.dropped(); dropped != m_samples_dropped) {
+            m_samples_dropped = dropped;
+            fresh_after = std::chrono::steady_clock::now();
+            m_sampler.sampleNow();
+        }
+        if (popped && newest.snap.taken_at >= fresh_after) {
             if (m_verbose_level >= 1) {
-                log_message(LOG, "Thread #{} - newer workspace change detected, skipping hide\n", local_handle_count);
+                auto late = std::chrono::duration_cast<std::chrono::microseconds>(newest.snap.taken_at - newest.due);
+                m_sample_late_total += late;
+                m_sample_late_max = std::max(m_sample_late_max, late);
             }
-            return; // A newer workspace change has occurred, don't hide
+            return newest.snap;
         }
-        
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Thread #{} - hiding waybar after delay\n", local_handle_count);
+        m_samples_skipped += popped;
+        m_sample_ready = false;
+        m_loop.waitFor(Constants::MAX_POLLING_INTERVAL * 2); // a stalled sampler cannot stall the loop
+        if (!m_sample_ready) {
+            fresh_after = std::chrono::steady_clock::now();
+            m_sampler.sampleNow();
         }
-        
-        // Hide waybar after duration
-        hideWaybar();
-        if (m_verbose_level >= 1) {
-            log_message(LOG, "Waybar hidden after workspace change (thread #{})\n", local_handle_count);
+    }
+    return last;
+}
+
+// Picks the next interval from the distance to the nearest activation zone or
+// hide threshold and from the cursor speed: fast near a zone, estimated time
+// of arrival while moving, exponential back-off while resting. --predict
+// needs a few samples of every move toward the top, so it never backs off
+// past the old fixed rate and samples an upward move at the fastest rate.
+auto Waybar::schedulePoll(const HyprSnapshot& snap) -> std::chrono::milliseconds {
+    using namespace std::chrono;
+    const int distance = distanceToZone(snap);
+    const auto elapsed = duration_cast<milliseconds>(snap.taken_at - m_last_sample.taken_at);
+    const int moved = std::abs(snap.cursor_x - m_last_sample.cursor_x) + std::abs(snap.cursor_y - m_last_sample.cursor_y);
+
+    const bool near_zone = distance <= Constants::NEAR_ZONE_DISTANCE;
+    const bool rising = m_predict && snap.cursor_y < m_last_sample.cursor_y;
+    const auto slowest = m_predict ? milliseconds(Constants::POLLING_INTERVAL) : milliseconds(Constants::MAX_POLLING_INTERVAL);
+
+    if (distance == 0 || (near_zone && moved > 0) || rising) {
+        m_poll_interval = Constants::MIN_POLLING_INTERVAL;
+    } else if (moved > 0 && elapsed.count() > 0) {
+        // sample twice before the cursor can reach the zone at its current speed
+        auto arrival = milliseconds(static_cast<long>(distance) * elapsed.count() / moved);
+        m_poll_interval = std::clamp(arrival / 2, milliseconds(Constants::MIN_POLLING_INTERVAL), slowest);
+    } else {
+        // resting close to a zone (tab bars...) never backs off past the old fixed rate
+        auto ceiling = near_zone ? milliseconds(Constants::POLLING_INTERVAL) : slowest;
+        m_poll_interval = std::min(m_poll_interval * 2, ceiling);
+    }
+    m_last_sample = snap;
+
+    if (m_verbose_level >= 2) {
+        log_message(TRACE, "Next sample in {}ms (cursor {}px from zone, moved {}px)\n", m_poll_interval.count(), distance, moved);
+    }
+    if (m_verbose_level >= 1) {
+        ++m_poll_samples;
+        auto window = snap.taken_at - m_poll_stats_start;
+        if (window >= Constants::POLL_STATS_INTERVAL) {
+            log_message(LOG, "Sampled cursor {} times in {}s (avg interval {}ms, current {}ms, late avg {}us max {}us, {} skipped, {} dropped)\n",
+                       m_poll_samples, duration_cast<seconds>(window).count(),
+                       duration_cast<milliseconds>(window).count() / m_poll_samples, m_poll_interval.count(),
+                       m_sample_late_total.count() / m_poll_samples, m_sample_late_max.count(), m_samples_skipped, m_samples_dropped);
+            m_poll_samples = 0;
+            m_sample_late_total = {};
+            m_sample_late_max = {};
+            m_poll_stats_start = snap.taken_at;
         }
-    }).detach();
+    }
+    return m_poll_interval;
+}
+
+// Pixels between the cursor and the line that matters on its monitor: the
+// activation zone while the bar is hidden, the hide threshold while it is shown
+auto Waybar::distanceToZone(const HyprSnapshot& snap) const -> int {
+    const int mon = m_zones.monitorAt(snap.cursor_x, snap.cursor_y);
+    if (mon < 0) {
+        return std::numeric_limits<int>::max(); // off every monitor, nothing to react to
+    }
+    const int slot = slotFor(mon);
+    bool shown = slot < 0 || m_slots[slot].visible();
+    if (shown) {
+        return std::abs(snap.cursor_y - m_zones.threshold[mon]);
+    }
+    return std::max(0, snap.cursor_y - (m_zones.zone_end[mon] - 1));
+}
+
+auto Waybar::readEvents() -> void {
+    if (!readHyprEvents(m_events, [this](std::string_view event, std::string_view data) {
+            handleHyprEvent(event, data);
+        })) {
+        log_message(WARN, "Hyprland closed the event socket, polling workspaces through hyprctl\n");
+        m_loop.unwatch(m_events.fd);
+        close(m_events.fd);
+        m_events.fd = -1;
+        m_events_live.store(false, std::memory_order_release);
+    }
+}
+
+auto Waybar::handleHyprEvent(std::string_view event, std::string_view data) -> void {
+    if (m_verbose_level >= 2) {
+        log_message(TRACE, "Hyprland event {}>>{}\n", event, data);
+    }
+
+    // Monitor hotplug: only queue the change here, the loops may hold references into m_outputs
+    if (event == "monitorremoved") {
+        m_removed_monitors.emplace_back(data);
+        m_topology_event = true;
+        m_loop.interrupt();
+        return;
+    }
+    if (event == "monitoradded" || event == "configreloaded") {
+        m_topology_event = true;
+        m_refetch_monitors = true;
+        m_loop.interrupt();
+        return;
+    }
+
+    // workspacev2>>ID,NAME carries the id; plain workspace>>NAME only for numeric names
+    if (event != "workspacev2" && event != "workspace") return;
+
+    int workspace = 0;
+    auto [end, err] = std::from_chars(data.data(), data.data() + data.size(), workspace);
+    if (err != std::errc{}) return;
+
+    int previous_workspace = g_current_workspace.load(std::memory_order_acquire);
+    if (workspace == previous_workspace) return;
+
+    g_current_workspace.store(workspace, std::memory_order_release);
+    m_workspace_event = true;
+    m_loop.interrupt();
+    if (m_verbose_level >= 1) {
+        log_message(LOG, "Workspace change detected: {} -> {}\n", previous_workspace, workspace);
+    }
 }
 
+// Applies queued monitor hotplug events to m_outputs without re-initializing.
+// Removals need no IPC; additions and config reloads re-fetch the geometry once.
+// Indices change, so hidden state is carried over by name and the zone table rebuilt.
+auto Waybar::applyTopologyChanges() -> void {
+    if (!std::exchange(m_topology_event, false)) return;
+
+    std::vector<std::string> hidden_names;
+    std::vector<std::string> known_names;
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+        known_names.push_back(m_outputs[i].name);
+        if (m_hidden[i]) hidden_names.push_back(m_outputs[i].name);
+    }
+
+    for (const auto& name : m_removed_monitors) {
+        auto removed = std::erase_if(m_outputs, [&name](const monitor_info_t& m) { return m.name == name; });
+        if (removed > 0) {
+            log_message(INFO, "Monitor {} removed\n", name);
+        }
+    }
+    m_removed_monitors.clear();
+
+    if (std::exchange(m_refetch_monitors, false)) {
+        std::vector<monitor_info_t> fresh;
+        try {
+            fresh = getMonitorsInfo();
+        } catch (const std::exception& e) {
+            log_message(WARN, "Failed to refresh monitors: {}\n", e.what());
+            fresh = m_outputs; // keep applying the removals
+        }
+
+        for (const auto& mon : fresh) {
+            auto known = std::find_if(m_outputs.cbegin(), m_outputs.cend(), [&mon](const monitor_info_t& m) {
+                return m.name == mon.name;
+            });
+            if (known == m_outputs.cend()) {
+                log_message(INFO, "Monitor {} added\n", mon.name);
+            } else if (!(*known == mon)) {
+                log_message(INFO, "Monitor {} geometry changed\n", mon.name);
+            }
+        }
+        m_outputs = std::move(fresh);
+    }
+
+    if (m_original_mode == BarMode::HIDE_FOCUSED) {
+        std::sort(m_outputs.begin(), m_outputs.end());
+    }
+    rebuildZones();
 
+    // new monitors start like they would at launch
+    auto contains = [](const std::vector<std::string>& names, const std::string& name) {
+        return std::find(names.cbegin(), names.cend(), name) != names.cend();
+    };
+    m_hidden.reset();
+    for (size_t i = 0; i < m_outputs.size(); ++i) {
+        const auto& name = m_outputs[i].name;
+        m_hidden[i] = contains(known_names, name) ? contains(hidden_names, name) : m_zones.targets[i];
+    }
 
+    if (m_policy.per_monitor) {
+        setupSlots(m_policy);
+    }
+    if (m_use_pool) {
+        syncPoolTopology();
+    }
+    if (m_policy.per_monitor && !m_variant_link.empty()) {
+        m_variants.clear(); // written for the old indices
+        writeVisibleMonitors();
+    }
+}
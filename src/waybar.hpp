@@ -1,14 +1,18 @@
 #include <array>
+#include <bitset>
+#include <cstdint>
 #include <csignal>
 #include <memory>
 #include <atomic>
-#include "json/value.h"
-#include "json/reader.h"
-#include "json/writer.h"
 #include <filesystem>
 #include <fstream>
 #include <signal.h>
 #include "utils.hpp"
+#include "loop.hpp"
+#include "supervisor.hpp"
+#include "intents.hpp"
+#include "sampler.hpp"
+#include "predictor.hpp"
 #include <vector>
 #include <iomanip>
 
@@ -22,17 +26,30 @@ inline auto printHelp() -> void;
 namespace Constants {
     constexpr int DEFAULT_BAR_THRESHOLD = 100;
     constexpr int MOUSE_ACTIVATION_ZONE = 1;  // pixels from top of monitor
-    constexpr auto POLLING_INTERVAL = 80ms;   // mouse position polling frequency
+    constexpr auto POLLING_INTERVAL = 80ms;   // mouse position polling frequency when the scheduler has no history
+    constexpr auto MIN_POLLING_INTERVAL = 8ms;   // sampling rate right at the activation zone / threshold
+    constexpr auto MAX_POLLING_INTERVAL = 500ms; // back-off ceiling for a far away or resting cursor
+    constexpr int NEAR_ZONE_DISTANCE = 40;       // pixels from a zone that always get the fastest rate
+    constexpr auto POLL_STATS_INTERVAL = 10s;    // how often -v reports the sampling rate
     constexpr int MIN_THRESHOLD = 1;          // minimum threshold value
     constexpr int MAX_THRESHOLD = 1000;       // maximum threshold value
     constexpr int MONITOR_MODE_PREFIX_LENGTH = 4;  // "mon:" prefix length
     constexpr int SINGLE_MONITOR_THRESHOLD = 1;    // fallback threshold for single monitor
-    constexpr int CONFIG_FLAG_COUNT = 4;           // number of command line flags
+    constexpr int CONFIG_FLAG_COUNT = 11;           // number of command line flags
     constexpr auto WORKSPACE_SHOW_DURATION = 1000ms;   // how long to show waybar after workspace change
     constexpr auto MOUSE_ACTIVATION_DELAY = 250ms; // how long mouse must be in activation zone
-    constexpr int MAX_WAYBAR_CRASHES = 3;          // maximum waybar crashes before giving up
-    constexpr auto WAYBAR_CRASH_WINDOW = 30s;      // time window for crash counting
-    constexpr auto ENVIRONMENT_RETRY_INTERVAL = 10s; // how long to wait between environment checks
+    constexpr auto RELOAD_COALESCE_WINDOW = 30ms;  // visibility changes within this window share one reload
+    constexpr int MAX_RELOAD_WINDOW = 1000;        // maximum --reload-window in ms
+    constexpr auto CONFIG_SETTLE_DELAY = 100ms;    // editors save in several steps, re-read once they are done
+    constexpr size_t MAX_PRECOMPUTED_VARIANTS = 64; // config variants written at startup, the rest on first use
+    constexpr size_t INTENT_QUEUE_CAPACITY = 64;    // pending show/hide/reload intents, a full queue resyncs every waybar
+    constexpr auto BAR_HIDE_DELAY = 0ms;           // how long the cursor stays past the threshold before the bar hides
+    constexpr auto WAYBAR_RESTART_BACKOFF_MIN = 250ms; // first restart delay, doubled per consecutive failure
+    constexpr auto WAYBAR_RESTART_BACKOFF_MAX = 30s;   // backoff ceiling, waybar is retried forever
+    constexpr auto WAYBAR_STABLE_AFTER = 30s;      // a waybar up this long starts the backoff over
+    constexpr auto WAYBAR_STARTUP_GRACE = 500ms;   // a waybar that survives this long counts as started
+    constexpr auto WAYBAR_STOP_TIMEOUT = 1000ms;   // SIGTERM grace before SIGKILL
+    constexpr auto ENVIRONMENT_RETRY_INTERVAL = 1s; // re-check when no inotify event arrives
     constexpr auto ENVIRONMENT_RETRY_TIMEOUT = 10min; // how long to keep trying before giving up
 }
 
@@ -40,7 +57,6 @@ namespace Constants {
 struct monitor_info_t {
     std::string name{};
     int x_coord{}, y_coord{}, width{}, height{};
-    bool hidden = false;
 
     // for sorting - improved comparison logic
     bool operator<(const monitor_info_t& other) const {
@@ -61,6 +77,118 @@ struct monitor_info_t {
     }
 };
 
+// Monitor rectangles and the lines that matter for the bar, as parallel arrays
+// indexed like the monitor list they were built from. by_x orders monitors by
+// left edge; with the running maximum of right edges, finding the monitor
+// under the cursor is a binary search plus a short walk over monitors stacked
+// vertically. Rebuilt only when the topology changes.
+struct hot_zone_table_t {
+    static constexpr size_t MAX_MONITORS = 32;
+    using monitor_set_t = std::bitset<MAX_MONITORS>;
+
+    std::vector<int> left, right, top, bottom; // inclusive edges
+    std::vector<int> zone_end;                 // cursor above this y is in the activation zone
+    std::vector<int> threshold;                // cursor below this y hides a shown bar
+    std::vector<int> sorted_left;              // left edges in by_x order
+    std::vector<int> max_right;                // running max of right edges in by_x order
+    std::vector<std::uint8_t> by_x;
+    monitor_set_t targets;                     // mon:<names> resolved to indices
+
+    auto build(const std::vector<monitor_info_t>& monitors, int bar_threshold,
+               const std::vector<std::string>& target_names) -> void;
+    auto monitorAt(int x, int y) const -> int; // -1 when the cursor is on no monitor
+    auto size() const -> size_t { return left.size(); }
+};
+
+// Bar visibility, the same state machine in every mode. A slot is one bar:
+// a single slot for HIDE_ALL, one per monitor otherwise. Each tick feeds the
+// slot under the cursor a few events and takes at most one step per event,
+// so nothing ever waits for the cursor to leave.
+enum class BarState : std::uint8_t {
+    Hidden,
+    Arming, // cursor in the activation zone, waiting out the activation delay
+    Shown,
+    Hiding  // cursor past the threshold, waiting out the hide delay
+};
+
+enum class BarEvent : std::uint8_t {
+    EnterZone, LeaveZone, ArmElapsed,
+    PastThreshold, WithinThreshold, HideElapsed,
+    Reveal,     // workspace switch
+    Predicted,  // --predict: the cursor is on its way to the zone
+    HoldElapsed // a revealed bar may hide again
+};
+
+struct bar_slot_t {
+    BarState state = BarState::Hidden;
+    std::chrono::steady_clock::time_point since{};      // entered the current state
+    std::chrono::steady_clock::time_point hold_until{}; // set by Reveal, ignores the threshold until then
+    bool predicted = false; // shown by Predicted, the cursor has not reached the zone yet
+
+    auto visible() const -> bool { return state == BarState::Shown || state == BarState::Hiding; }
+};
+
+// What makes the modes differ
+struct bar_policy_t {
+    bool per_monitor = false;  // one slot per monitor, applied through the config outputs
+    bool targets_only = false; // mon:<names>, the other monitors keep their bar
+    std::chrono::milliseconds arm_delay{};
+    std::chrono::milliseconds hide_delay{};
+};
+
+// How much the reload coalescer saved, reported with -v
+struct reload_stats_t {
+    int changes = 0;  // visibility changes requested, each used to cost a reload
+    int reloads = 0;  // config writes + SIGUSR2 actually sent for them
+};
+
+// Intents drained versus signals they turned into, reported with -v
+struct intent_stats_t {
+    int intents = 0;
+    int signals = 0;    // SIGUSR1/SIGUSR2 actually sent
+    int overflows = 0;  // queue was full, every waybar was resynced instead
+};
+
+// Early reveals from --predict, reported with -v
+struct predict_stats_t {
+    int reveals = 0;
+    int confirmed = 0; // the cursor reached the zone within the hold
+    int false_reveals = 0;
+};
+
+// Byte range of the top-level "output" value in the raw config text. Config
+// variants splice a new value into that range, so everything else in the
+// user's file, comments and formatting included, is copied through untouched.
+struct config_span_t {
+    size_t begin = 0, end = 0;
+    int entries = -1; // array length, -1 when output is not an array
+    bool null = false;
+};
+
+// Config variants written versus visibility switches served by them
+struct config_write_stats_t {
+    int writes = 0;         // variants generated
+    size_t file_bytes = 0;  // bytes written for them, all in $XDG_RUNTIME_DIR
+    int switches = 0;       // symlink swaps
+};
+
+// --hypr-hide/--hypr-show: Hyprland commands that hide and show the bar on
+// one monitor, "{}" standing for its name. When set, per-monitor modes leave
+// waybar and its config alone and send these over the IPC socket instead.
+struct hypr_commands_t {
+    std::string hide{};
+    std::string show{};
+
+    auto enabled() const -> bool { return !hide.empty(); }
+};
+
+// buffered reader state for Hyprland's socket2 event stream
+struct hypr_event_stream_t {
+    int fd = -1;
+    std::array<char, 4096> buf{};
+    size_t len = 0;
+};
+
 enum class BarMode : std::uint8_t {
     HIDE_ALL,
     HIDE_FOCUSED,
@@ -69,74 +197,89 @@ enum class BarMode : std::uint8_t {
 
 class Waybar {
 public:
-    Waybar(const std::string &mode, int threshold, int verbose, const std::string &config_dir);
+    Waybar(const std::string &mode, int threshold, int verbose, const std::string &config_dir,
+           std::chrono::milliseconds reload_window = Constants::RELOAD_COALESCE_WINDOW, bool pool = false,
+           hypr_commands_t hypr_commands = {}, bool standby = false, bool predict = false,
+           const std::string &trace_path = {});
     ~Waybar();
     auto run() -> void; // calls the apropiate operation mode
     auto reloadPid() -> void; // sigusr2
-    auto restoreOriginal() -> void; // restore original waybar config
+    auto restoreOriginal() -> void; // point waybar back at the user's own config
     auto setBarMode(BarMode mode); // setter for mode
     auto shutdown() -> void; // properly terminate waybar process
 private:
     // modes
-    auto hideAllMonitors(bool is_visible = true) -> void;
+    auto hideAllMonitors() -> void;
     auto hideFocused() -> void;                  
     auto hideCustom() -> void;
     auto parseMode(const std::string &mode) -> BarMode;
     auto runFocusedMode() -> void;
     auto runCustomMode() -> void;
     auto validateMonitorExists() -> void;
+    auto getTargetMonitors() const -> std::vector<std::string>;
     
     // custom mode helpers
     auto setupCustomMode() -> void;
-    auto runCustomModeLoop() -> void;
-    auto initializeCustomModeMouse() -> std::pair<int, int>;
-    auto processCustomModeIteration(int mouse_x, int mouse_y) -> bool;
-    auto showHiddenMonitor(monitor_info_t& mon) -> bool;
     auto cleanupCustomMode() -> void;
-    auto handleMonitorThreshold(monitor_info_t& mon, int& mouse_x, int& mouse_y, int local_bar_threshold) -> bool;
     
     // focused mode helpers
     auto setupFocusedMode() -> void;
     auto validateFocusedModeConfig() -> void;
-    auto runFocusedModeLoop() -> void;
-    auto initializeMousePosition() -> std::pair<int, int>;
-    auto applyChanges(bool need_reload) -> void;
-    auto sleepAndUpdateMouse(int& mouse_x, int& mouse_y) -> void;
     auto cleanupFocusedMode() -> void;
-    auto processFocusedMonitors(int mouse_x, int mouse_y) -> bool;
-    auto isCursorInCurrentMonitor(const monitor_info_t& mon, int mouse_x, int mouse_y) -> bool;
-    auto processCurrentMonitor(monitor_info_t& mon, int mouse_x, int mouse_y) -> bool;
-    auto handleVisibleMonitor(monitor_info_t& mon, int mouse_x, int mouse_y) -> bool;
-    auto handleHiddenMonitor(monitor_info_t& mon, int mouse_x, int mouse_y) -> bool;
     
     // all monitors mode helpers
-    auto setupAllMonitorsMode(bool& is_visible) -> void;
-    auto runAllMonitorsLoop(bool is_visible) -> void;
+    auto setupAllMonitorsMode() -> void;
     auto cleanupAllMonitorsMode() -> void;
-    auto processAllMonitorsVisibility(int root_x, int root_y, bool is_visible) -> bool;
-    auto processMonitorVisibility(const monitor_info_t& mon, int root_y, bool is_visible) -> bool;
-    auto showWaybarAndKeepOpen(const monitor_info_t& mon, int local_bar_threshold) -> bool;
-    auto hideWaybarAndReturnFalse() -> bool;
-    auto shouldShowWaybar(const monitor_info_t& mon, int root_y) const -> bool;
-    auto shouldHideWaybar(const monitor_info_t& mon, int root_y, int threshold) const -> bool;
-    auto checkMouseActivationDelay() -> bool;
     auto showWaybar() -> void;
     auto hideWaybar() -> void;
+
+    // visibility state machine, shared by all modes
+    auto setupSlots(const bar_policy_t& policy) -> void; // seeds the slots from the current visibility
+    auto slotFor(int mon) const -> int;                  // -1 for monitors the mode leaves alone
+    auto runVisibilityLoop() -> void;
+    auto advanceVisibility(const HyprSnapshot& snap) -> void;
+    auto fireBarEvent(int slot, BarEvent event, std::chrono::steady_clock::time_point now) -> void;
+    auto recordTrace(const HyprSnapshot& snap) -> void; // --record-trace, one line per sample
+    auto applyVisibility() -> void;                      // slots -> SIGUSR1 or config outputs
     
     // workspace monitoring helpers
-    auto getCurrentWorkspace() const -> int;
-    auto checkWorkspaceChange() const -> bool;
-    auto handleWorkspaceChange() -> void;
+    auto takeSnapshot() const -> HyprSnapshot;   // the one IPC round trip of a tick, safe on the sampler thread
+    auto getCurrentWorkspace() const -> int;     // hyprctl fallback
+    auto checkWorkspaceChange(const HyprSnapshot& snap) -> bool;
+    auto handleWorkspaceChange(const HyprSnapshot& snap) -> void;
+
+    // socket2 events
+    auto nextSample(const HyprSnapshot& last) -> HyprSnapshot; // waits in the loop for the sampler thread
+    auto schedulePoll(const HyprSnapshot& snap) -> std::chrono::milliseconds;
+    auto distanceToZone(const HyprSnapshot& snap) const -> int;
+    auto readEvents() -> void;
+    auto handleHyprEvent(std::string_view event, std::string_view data) -> void;
+    auto applyTopologyChanges() -> void; // monitor hotplug
 
     // monitors
-    auto getMonitor(const std::string &name) -> monitor_info_t&; // retrieves the monitor info by a name
-    auto requestApplyVisibleMonitors(bool need_reload) -> void; 
+    auto requestApplyVisibleMonitors(bool need_reload) -> void; // queues the change for the coalescer
+    auto flushVisibleMonitors() -> void;  // coalescing window closed
+    auto writeVisibleMonitors() -> void;  // unconditional config write + reload
+    auto renderOutputs(const hot_zone_table_t::monitor_set_t& hidden) -> std::string_view;
+    auto sendHyprCommands(bool show_all) -> void; // --hypr-hide/--hypr-show for the monitors that changed
+    auto logReloadStats() const -> void;
+    auto rebuildZones() -> void;
 
     // misc
-    auto initPid() const -> pid_t;               // retreives pid of waybar
-    auto initPidOrRestart() -> pid_t;           // gets pid or restarts waybar if not running
-    auto restartWaybar() -> pid_t;               // restarts waybar process
-    auto checkWaybarCrashLimit() -> bool;       // checks if waybar has crashed too many times
+    auto initPidOrRestart() -> void;            // replaces any running waybar with our own children
+    auto startWaybars() -> void;                 // one shared waybar, or the --pool instances
+    auto setWaybarVisible(size_t index, bool visible) -> bool; // SIGUSR1 only on a mismatch, false while it restarts
+    auto handleWaybarUp(size_t index) -> void;   // a (re)started waybar gets the state the loop wants
+    auto prepareStandby(size_t index) -> std::string; // hidden copy of the instance's config, returns the -c link
+    auto promoteStandby(size_t index) -> void;   // that link now leads to the instance's real config
+    auto instanceConfigPath(const waybar_instance_t& bar) const -> std::string; // the variant link or output-<name>
+    auto addPoolInstance(const std::string& output) -> void;
+    auto writeOutputConfig(const std::string& output) -> void; // the user's config with only that output
+    auto wantedVisible(size_t index) const -> bool; // what the slots / m_hidden say that waybar should show
+    auto syncWaybar(size_t index) -> void;       // posts the intent that brings it there, if any
+    auto postIntent(size_t index, WaybarIntent kind) -> void;
+    auto drainIntents() -> void;                 // the only place waybar visibility is signalled
+    auto syncPoolTopology() -> void;             // instances for added monitors, none for removed ones
     auto enforceSingleWaybar() -> void;         // enforces single waybar policy
     auto isEnvironmentReady() -> bool;          // checks if Hyprland/Wayland environment is ready
     auto waitForEnvironmentReady() -> bool;     // waits for environment to be ready with retry logic
@@ -153,43 +296,82 @@ private:
     auto validateConfig() -> void;
     auto getConfigPath() -> std::string;
     auto isValidConfigPath(const std::string& path) const -> bool;
-    auto saveConfig() -> void;
-    auto getOutputs() -> Json::Value&;
-    auto setOutputs(const Json::Value &outputs) -> void;
-    auto handleSignal(int signal) -> void {
-        if (signal == SIGINT || signal == SIGTERM || signal == SIGHUP) {
-            log_message(WARN, "Interruption detected, saving resources...\n");
-            // Note: This function is no longer used since we use global signal handlers
-        }
-    }
-    static void cleanupSignals() {
-        std::signal(SIGINT, SIG_DFL);
-        std::signal(SIGTERM, SIG_DFL);
-        std::signal(SIGHUP, SIG_DFL);
-    }
+    auto configVariantPath(std::uint32_t hidden) const -> std::string;
+    auto prepareConfigVariants() -> void;    // runtime dir + the link waybar is started with
+    auto precomputeConfigVariants() -> void; // the states this mode is expected to visit
+    auto writeConfigVariant(std::uint32_t hidden) -> void;
+    auto selectConfigVariant() -> void;      // m_hidden -> symlink swap, generating on first use
+    auto removeConfigVariants() -> void;
+    auto watchConfig() -> void;              // inotify on the config and the directories it lives in
+    auto readConfigEvents() -> void;
+    auto reloadChangedConfig() -> void;      // re-parse after an edit, regenerate the variants
+    auto logConfigWriteStats() const -> void;
 
-    pid_t m_waybar_pid;
+    EventLoop m_loop;                    // everything waits here: socket2, timers, signals
+    int m_workspace_hide_timer = -1;     // deadline for hiding after a workspace switch
+    int m_reload_timer = -1;             // closes the reload coalescing window
+    bool m_pool_requested = false;       // --pool
+    bool m_use_pool = false;             // --pool and a per-monitor mode with several monitors
+    bool m_standby = false;              // --warm-standby
+    WaybarSupervisor m_waybars;          // [0] is the shared instance without the pool
+    IntentQueue m_intents{Constants::INTENT_QUEUE_CAPACITY}; // show/hide/reload for m_waybars, watched by m_loop
+    std::vector<waybar_intent_t> m_intent_batch{};
+    std::vector<std::pair<int, bool>> m_intent_folds{}; // per instance: wanted visibility (-1 unchanged), reload
+    intent_stats_t m_intent_stats{};
+    hypr_commands_t m_hypr_commands{};
+    std::vector<std::string> m_hypr_hidden{};    // monitors the hide command was sent for
+    std::string m_hidemon{}; // for mode BarMode::HIDE_MON, set by parseMode so it must precede m_original_mode
     BarMode m_original_mode = BarMode::HIDE_ALL;
     bool m_is_console;
     int m_verbose_level;
     int m_bar_threshold = Constants::DEFAULT_BAR_THRESHOLD;
-    bool m_waybar_visible = false;  // track current waybar visibility state
-    std::chrono::steady_clock::time_point m_mouse_activation_start{}; // when mouse entered activation zone
-    bool m_mouse_in_activation_zone = false; // track if mouse is currently in activation zone
-    std::string m_hidemon{}; // for mode BarMode::HIDE_MON
+    // adaptive polling: previous sample and the interval chosen from it
+    std::chrono::milliseconds m_poll_interval = Constants::POLLING_INTERVAL;
+    HyprSnapshot m_last_sample{};
+    CursorSampler m_sampler;             // takes the snapshots off the loop's thread while the loop runs
+    int m_poll_samples = 0;
+    bool m_predict = false;              // --predict
+    RevealPredictor m_predictor{};
+    predict_stats_t m_predict_stats{};
+    int m_predict_hold_timer = -1;       // ticks when an early reveal may hide again
+    std::ofstream m_trace;               // --record-trace, replayed by autowaybar-replay
+    std::chrono::steady_clock::time_point m_trace_start{};
+    bool m_sample_ready = false;         // set by the sampler fd, tells nextSample why the wait ended
+    std::chrono::microseconds m_sample_late_total{}, m_sample_late_max{}; // sample time behind its schedule, -v
+    int m_samples_skipped = 0;           // queued behind a newer sample, or taken before a fresh one was asked for
+    int m_samples_dropped = 0;           // m_sampler.dropped() as last seen
+    std::chrono::steady_clock::time_point m_poll_stats_start{};
+    hypr_event_stream_t m_events{};      // socket2 (watched by m_loop), fd -1 when we have to poll hyprctl
+    std::atomic<bool> m_events_live{false}; // m_events.fd != -1, for the sampler thread
+    bool m_workspace_event = false;      // set by handleHyprEvent, consumed by checkWorkspaceChange
+    bool m_topology_event = false;       // monitor hotplug pending, consumed by applyTopologyChanges
+    bool m_refetch_monitors = false;     // monitoradded/configreloaded need fresh geometry
+    std::vector<std::string> m_removed_monitors{};
     std::vector<monitor_info_t> m_outputs{};
+    hot_zone_table_t m_zones{};          // indexed like m_outputs
+    hot_zone_table_t::monitor_set_t m_hidden{};         // per m_outputs index, focused and custom modes
+    hot_zone_table_t::monitor_set_t m_applied_hidden{}; // what the written config currently hides
+    hot_zone_table_t::monitor_set_t m_requested_hidden{}; // last m_hidden seen by the coalescer
+    std::chrono::milliseconds m_reload_window;
+    bool m_reload_pending = false;
+    reload_stats_t m_reload_stats{};
+    bar_policy_t m_policy{};
+    std::vector<bar_slot_t> m_slots{};   // one per bar, see bar_policy_t::per_monitor
     std::string m_config_path;
     std::string m_config_dir;
-    Json::Value m_config;
-    Json::Value m_backup;
-    
-    // Waybar crash tracking
-    int m_waybar_crash_count = 0;
-    std::chrono::steady_clock::time_point m_crash_window_start{};
-    
-    // Environment readiness tracking
-    int m_environment_retry_count = 0;
-    std::chrono::steady_clock::time_point m_environment_retry_start{};
+    std::string m_config_text;           // config file as read, every variant is spliced from it
+    config_span_t m_output_span{};       // where "output" sits in m_config_text
+    size_t m_config_body = 0;            // just past the top-level '{', where start_hidden goes
+    bool m_config_has_members = false;   // a start_hidden put at m_config_body needs a comma after it
+    config_span_t m_start_hidden_span{}; // from after the "start_hidden" key to the end of its value, end 0 when absent
+    std::string m_outputs_text;          // replacement for that span, reused between writes
+    std::string m_variant_dir;           // $XDG_RUNTIME_DIR/autowaybar, one config per hidden set
+    std::string m_variant_link;          // waybar -c target, swapped between variants
+    std::vector<std::uint32_t> m_variants{}; // hidden sets already written, per current m_outputs order
+    int m_config_watch_fd = -1;          // inotify, watched by m_loop
+    int m_config_settle_timer = -1;      // re-reads the config once the events stop
+    std::vector<std::string> m_config_watch_names{}; // entries that are our config in the watched directories
+    config_write_stats_t m_config_writes{};
     
     // Logging
     std::string m_log_file_path;
@@ -217,6 +399,13 @@ inline auto printHelp() -> void {
     constexpr std::array<Flag, Constants::CONFIG_FLAG_COUNT> flags = {{
         {.name = "-m --mode", .description = "Select the operation mode for waybar (default: all)."},
         {.name = "-t --threshold", .description = "Threshold in pixels that should match your waybar width"},
+        {.name = "-r --reload-window", .description = "Milliseconds to merge monitor visibility changes into one reload (default: 30)"},
+        {.name = "-p --pool", .description = "Run one waybar per monitor and toggle each directly (focused and mon: modes)"},
+        {.name = "-H --hypr-hide", .description = "Hyprland command that hides the bar on monitor {} instead of reloading waybar"},
+        {.name = "-S --hypr-show", .description = "Hyprland command that shows it again, required with --hypr-hide"},
+        {.name = "-w --warm-standby", .description = "Keep a hidden spare waybar that takes over at once when one crashes"},
+        {.name = "-P --predict", .description = "Start the reveal early when the cursor moves quickly toward the top edge"},
+        {.name = "-T --record-trace", .description = "Append every cursor sample to <file>, for autowaybar-replay"},
         {.name = "-h --help", .description = "Show this help"},
         {.name = "-v --verbose", .description = "Enable verbose output (-v for LOG level, -vv for TRACE level)"}
     }};
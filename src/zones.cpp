@@ -0,0 +1,52 @@
+#include "waybar.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+auto hot_zone_table_t::build(const std::vector<monitor_info_t>& monitors, int bar_threshold,
+                             const std::vector<std::string>& target_names) -> void {
+    if (monitors.size() > MAX_MONITORS) {
+        throw std::runtime_error("Too many monitors: " + std::to_string(monitors.size()));
+    }
+
+    const size_t count = monitors.size();
+    for (auto* column : {&left, &right, &top, &bottom, &zone_end, &threshold, &sorted_left, &max_right}) {
+        column->resize(count);
+    }
+    by_x.resize(count);
+    targets.reset();
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto& mon = monitors[i];
+        left[i] = mon.x_coord;
+        right[i] = mon.x_coord + mon.width;
+        top[i] = mon.y_coord;
+        bottom[i] = mon.y_coord + mon.height;
+        zone_end[i] = mon.y_coord + Constants::MOUSE_ACTIVATION_ZONE;
+        threshold[i] = mon.y_coord + bar_threshold;
+        targets[i] = std::find(target_names.cbegin(), target_names.cend(), mon.name) != target_names.cend();
+    }
+
+    std::iota(by_x.begin(), by_x.end(), 0);
+    std::sort(by_x.begin(), by_x.end(), [this](std::uint8_t a, std::uint8_t b) { return left[a] < left[b]; });
+    int running_right = std::numeric_limits<int>::min();
+    for (size_t i = 0; i < count; ++i) {
+        sorted_left[i] = left[by_x[i]];
+        running_right = std::max(running_right, right[by_x[i]]);
+        max_right[i] = running_right;
+    }
+}
+
+auto hot_zone_table_t::monitorAt(int x, int y) const -> int {
+    // candidates start left of x; walk back until no earlier monitor reaches x
+    auto candidates = std::upper_bound(sorted_left.cbegin(), sorted_left.cend(), x) - sorted_left.cbegin();
+    for (auto i = candidates; i-- > 0;) {
+        if (max_right[i] < x) break;
+        const int mon = by_x[i];
+        if (right[mon] >= x && top[mon] <= y && bottom[mon] >= y) {
+            return mon;
+        }
+    }
+    return -1;
+}
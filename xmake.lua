@@ -1,12 +1,22 @@
 add_rules("mode.debug", "mode.release")
-add_requires("fmt", "jsoncpp")
+add_requires("fmt")
+
+-- the benchmark's comparison with the old jsoncpp parse, off unless asked for: xmake f --bench-jsoncpp=y
+option("bench-jsoncpp")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Time the jsoncpp DOM parse next to JsonPull in autowaybar-bench")
+option_end()
+if has_config("bench-jsoncpp") then
+    add_requires("jsoncpp")
+end
 
 set_languages("c++20")
 
 target("autowaybar")
     set_kind("binary")
     add_files("src/*.cpp")
-    add_packages("fmt", "jsoncpp")
+    add_packages("fmt")
     
     add_cxxflags("-Wall", "-Wextra")
     
@@ -17,3 +27,43 @@ target("autowaybar")
     if is_mode("debug") then
         add_cxxflags("-g", "-O0", "-DDEBUG")
     end
+
+-- microbenchmarks, not built by default: xmake build autowaybar-bench
+target("autowaybar-bench")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/bench.cpp", "src/Hyprland.cpp", "src/utils.cpp", "src/jsonpull.cpp")
+    add_includedirs("src")
+    add_packages("fmt")
+    add_cxxflags("-Wall", "-Wextra", "-O2")
+    if has_config("bench-jsoncpp") then
+        add_packages("jsoncpp")
+        add_defines("BENCH_JSONCPP")
+    end
+
+-- replays --record-trace files through the --predict filter: xmake run autowaybar-replay trace...
+target("autowaybar-replay")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/replay.cpp", "src/predictor.cpp")
+    add_includedirs("src")
+    add_packages("fmt")
+    add_cxxflags("-Wall", "-Wextra", "-O2")
+
+-- stand-in Hyprland socket that checks the --hypr-hide batches: xmake run autowaybar-hyprstub
+target("autowaybar-hyprstub")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/hyprstub.cpp", "src/Hyprland.cpp", "src/utils.cpp", "src/jsonpull.cpp")
+    add_includedirs("src")
+    add_packages("fmt")
+    add_cxxflags("-Wall", "-Wextra", "-O2")
+
+-- checks the strict and JSONC modes of the config/hyprctl parser: xmake run autowaybar-jsonpull-check
+target("autowaybar-jsonpull-check")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/jsonpullcheck.cpp", "src/jsonpull.cpp")
+    add_includedirs("src")
+    add_packages("fmt")
+    add_cxxflags("-Wall", "-Wextra", "-O2")